@@ -20,6 +20,7 @@
 #include "utl/zip.h"
 
 #include "geo/box.h"
+#include "geo/fixed_geometry.h"
 #include "geo/fixed_latlng.h"
 #include "geo/latlng.h"
 
@@ -123,7 +124,7 @@ struct area_db_lookup {
           auto const area_idx = Idx{i};
           auto const& outer_rings = s.outer_rings_[area_idx];
 
-          auto box = geo::box{};
+          auto box = geo::fixed_box{};
           for (auto const [outer_idx, outer_ring] :
                utl::enumerate(outer_rings)) {
             tmp.inner_tmp_.clear();
@@ -144,8 +145,9 @@ struct area_db_lookup {
             tmp.polys_tmp_.emplace_back(poly);
           }
 
-          auto const min_corner = box.min_.lnglat();
-          auto const max_corner = box.max_.lnglat();
+          auto const bounds = box.to_box();
+          auto const min_corner = bounds.min_.lnglat();
+          auto const max_corner = bounds.max_.lnglat();
 
           idx_[i] = tg_geom_new_multipolygon(
               tmp.polys_tmp_.data(), static_cast<int>(tmp.polys_tmp_.size()));
@@ -0,0 +1,546 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "geo/cluster_nearby.h"
+#include "geo/constants.h"
+#include "geo/fixed_latlng.h"
+#include "geo/latlng.h"
+#include "geo/xyz.h"
+
+namespace geo {
+
+// Metrics for the clustering engine. All distances are in meters.
+//
+// A metric defines:
+//   - point_t: prepared representation of a coordinate
+//   - prepare(latlng) -> point_t
+//   - to_xyz(point_t) -> xyz (used for the neighbour grid)
+//   - operator()(point_t, point_t) -> distance
+//   - max_chord(d): upper bound of the chord length (meters) between two
+//     points with distance <= d
+
+// Great circle distance (computed via the chord, see xyz.h).
+struct haversine_metric {
+  using point_t = xyz;
+
+  static xyz prepare(latlng const& x) { return xyz{x}; }
+  static xyz const& to_xyz(xyz const& x) { return x; }
+  double operator()(xyz const& a, xyz const& b) const {
+    return haversine_distance(a, b);
+  }
+  static double max_chord(double const d) {
+    return 2.0 * kEarthRadiusMeters *
+           std::sin(std::min(d / (2.0 * kEarthRadiusMeters), kPI / 2.0));
+  }
+};
+
+// Straight line distance through the earth (ECEF chord).
+// Underestimates the great circle distance by less than 0.1% below 100km.
+struct chord_metric {
+  using point_t = xyz;
+
+  static xyz prepare(latlng const& x) { return xyz{x}; }
+  static xyz const& to_xyz(xyz const& x) { return x; }
+  double operator()(xyz const& a, xyz const& b) const {
+    auto const dx = a.x_ - b.x_;
+    auto const dy = a.y_ - b.y_;
+    auto const dz = a.z_ - b.z_;
+    return 2.0 * kEarthRadiusMeters * std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+  static double max_chord(double const d) { return d; }
+};
+
+// Equirectangular approximation (distance<kEquirectangular>).
+// Only suitable for small distances (< 0.1% error below 10km outside of the
+// polar regions), the neighbour search assumes it to be within 10% of the
+// great circle distance.
+struct equirectangular_metric {
+  using point_t = latlng;
+
+  static latlng const& prepare(latlng const& x) { return x; }
+  static xyz to_xyz(latlng const& x) { return xyz{x}; }
+  double operator()(latlng const& a, latlng const& b) const {
+    return distance<distance_type::kEquirectangular>(a, b);
+  }
+  static double max_chord(double const d) {
+    return haversine_metric::max_chord(d * 1.1);
+  }
+};
+
+namespace detail {
+
+// Uniform grid over xyz coordinates. With a cell size of at least the chord
+// length of the search radius, all points within the radius are located in
+// the same or one of the 26 adjacent cells.
+struct chord_grid {
+  struct cell {
+    friend bool operator<(cell const& a, cell const& b) {
+      return std::tie(a.x_, a.y_, a.z_) < std::tie(b.x_, b.y_, b.z_);
+    }
+    std::int64_t x_, y_, z_;
+  };
+
+  // max_chord: meters
+  chord_grid(std::vector<xyz> const& points, double const max_chord)
+      : cell_size_{std::max(max_chord / (2.0 * kEarthRadiusMeters), 1e-9)} {
+    cells_.reserve(points.size());
+    for (auto i = 0U; i < points.size(); ++i) {
+      cells_.emplace_back(get_cell(points[i]), static_cast<cluster_id_t>(i));
+    }
+    std::sort(begin(cells_), end(cells_));
+  }
+
+  cell get_cell(xyz const& p) const {
+    auto const to_cell = [&](double const v) {
+      return static_cast<std::int64_t>(std::floor(v / cell_size_));
+    };
+    return {to_cell(p.x_), to_cell(p.y_), to_cell(p.z_)};
+  }
+
+  // calls fn(j) for every point j in the neighbourhood of p (incl. p itself)
+  template <typename Fn>
+  void for_each_candidate(xyz const& p, Fn&& fn) const {
+    auto const c = get_cell(p);
+    for (auto dx = -1; dx <= 1; ++dx) {
+      for (auto dy = -1; dy <= 1; ++dy) {
+        // cells (x, y, z-1), (x, y, z), (x, y, z+1) are consecutive
+        auto const from = cell{c.x_ + dx, c.y_ + dy, c.z_ - 1};
+        auto const to = cell{c.x_ + dx, c.y_ + dy, c.z_ + 1};
+        auto it = std::lower_bound(
+            begin(cells_), end(cells_), from,
+            [](auto const& a, cell const& b) { return a.first < b; });
+        for (; it != end(cells_) && !(to < it->first); ++it) {
+          fn(it->second);
+        }
+      }
+    }
+  }
+
+  double cell_size_;
+  std::vector<std::pair<cell, cluster_id_t>> cells_;
+};
+
+}  // namespace detail
+
+// Fixed radius neighbour search over a random access container of latlng or
+// fixed_latlng (anything convertible to latlng).
+template <typename Metric = haversine_metric>
+struct neighbor_index {
+  template <typename Coords>
+  neighbor_index(Coords const& coords, double const max_dist,
+                 Metric metric = {})
+      : metric_{std::move(metric)},
+        max_dist_{max_dist},
+        points_{prepare(coords)},
+        grid_{to_xyz(points_), Metric::max_chord(max_dist)} {}
+
+  template <typename Coords>
+  static std::vector<typename Metric::point_t> prepare(Coords const& coords) {
+    std::vector<typename Metric::point_t> points;
+    points.reserve(coords.size());
+    for (auto i = std::size_t{0U}; i < coords.size(); ++i) {
+      points.emplace_back(Metric::prepare(static_cast<latlng>(coords[i])));
+    }
+    return points;
+  }
+
+  static std::vector<xyz> to_xyz(
+      std::vector<typename Metric::point_t> const& points) {
+    std::vector<xyz> xyz_points;
+    xyz_points.reserve(points.size());
+    for (auto const& p : points) {
+      xyz_points.emplace_back(Metric::to_xyz(p));
+    }
+    return xyz_points;
+  }
+
+  std::size_t size() const { return points_.size(); }
+
+  // calls fn(j, distance) for every j != i with distance(i, j) <= max_dist
+  template <typename Fn>
+  void for_each_neighbor(cluster_id_t const i, Fn&& fn) const {
+    grid_.for_each_candidate(
+        Metric::to_xyz(points_[i]), [&](cluster_id_t const j) {
+          if (j == i) {
+            return;
+          }
+          auto const dist = metric_(points_[std::min(i, j)],
+                                    points_[std::max(i, j)]);
+          if (dist <= max_dist_) {
+            fn(j, dist);
+          }
+        });
+  }
+
+  Metric metric_;
+  double max_dist_;
+  std::vector<typename Metric::point_t> points_;
+  detail::chord_grid grid_;
+};
+
+// Single linkage: connected components of the "distance <= max_dist" graph.
+// Cluster id = smallest index of the cluster members.
+template <typename Metric>
+std::vector<cluster_id_t> make_single_linkage_clusters(
+    neighbor_index<Metric> const& index) {
+  std::vector<cluster_id_t> clusters(index.size());
+  std::iota(begin(clusters), end(clusters), cluster_id_t{0U});
+
+  auto const find = [&](cluster_id_t x) {
+    while (clusters[x] != x) {
+      clusters[x] = clusters[clusters[x]];  // path halving
+      x = clusters[x];
+    }
+    return x;
+  };
+
+  for (auto i = cluster_id_t{0U}; i < index.size(); ++i) {
+    index.for_each_neighbor(i, [&](cluster_id_t const j, auto) {
+      if (j >= i) {
+        return;
+      }
+      auto const a = find(i);
+      auto const b = find(j);
+      if (a != b) {
+        clusters[std::max(a, b)] = std::min(a, b);
+      }
+    });
+  }
+
+  for (auto i = 0U; i < clusters.size(); ++i) {
+    clusters[i] = clusters[clusters[i]];
+  }
+  return clusters;
+}
+
+// Complete linkage: agglomerative clustering until no two clusters have a
+// maximum member distance <= max_dist.
+// Cluster id = smallest index of the cluster members.
+//
+// Two implementations with the same result (up to ties of distances):
+//   - nearest neighbour chain on the condensed distance matrix:
+//     O(n^2) time, n * (n - 1) / 2 distances (float: ~2n^2 bytes)
+//   - sparse: only pairs within max_dist are stored, in both directions
+//     (neighbour lists of {id, distance}). Fast for sparse components,
+//     dense ones take up to O(n^3) time.
+// The matrix is used up to max_matrix_bytes (default 64 MiB: ~5800 points
+// with float, ~4100 with double distances). Above, the close pairs are
+// counted first (one more neighbour search) and the smaller representation
+// is used: memory is bounded by min(matrix, neighbour lists).
+// With parallel cluster_nearby, every thread may hold one of them.
+constexpr auto const kCompleteLinkageMaxMatrixBytes = std::size_t{64U} << 20U;
+
+namespace detail {
+
+template <typename Metric>
+std::vector<cluster_id_t> complete_linkage_nn_chain(
+    neighbor_index<Metric> const& index) {
+  using dist_t = decltype(index.metric_(index.points_[0], index.points_[0]));
+  constexpr auto const kInf = std::numeric_limits<dist_t>::infinity();
+
+  // condensed upper triangle, kInf = not within max_dist (never merged)
+  auto const n = index.size();
+  auto const idx = [n](std::size_t const i, std::size_t const j) {
+    auto const [lo, hi] = std::minmax(i, j);
+    return lo * (2U * n - lo - 1U) / 2U + (hi - lo - 1U);
+  };
+  std::vector<dist_t> d(n * (n - 1U) / 2U, kInf);
+  for (auto i = cluster_id_t{0U}; i < n; ++i) {
+    index.for_each_neighbor(i, [&](cluster_id_t const j, dist_t const dist) {
+      if (i < j) {
+        d[idx(i, j)] = dist;
+      }
+    });
+  }
+
+  // merged clusters point to a cluster with a smaller id
+  std::vector<cluster_id_t> clusters(n);
+  std::iota(begin(clusters), end(clusters), cluster_id_t{0U});
+
+  // clusters that can still be merged, pos[c] = position in active
+  std::vector<cluster_id_t> active(n);
+  std::iota(begin(active), end(active), cluster_id_t{0U});
+  std::vector<std::size_t> pos(n);
+  std::iota(begin(pos), end(pos), std::size_t{0U});
+  auto const deactivate = [&](cluster_id_t const c) {
+    pos[active.back()] = pos[c];
+    active[pos[c]] = active.back();
+    active.pop_back();
+  };
+
+  // distances along the chain are non-increasing, every cluster's nearest
+  // neighbour is the next one (ties: the previous one, ensures progress)
+  std::vector<cluster_id_t> chain;
+  while (!active.empty()) {
+    if (chain.empty()) {
+      chain.push_back(active.back());
+    }
+
+    auto const x = chain.back();
+    auto const prev = chain.size() > 1U ? chain[chain.size() - 2U] : x;
+    auto best = prev == x ? kInf : d[idx(x, prev)];
+    auto y = prev;
+    for (auto const c : active) {
+      if (c != x && d[idx(x, c)] < best) {
+        best = d[idx(x, c)];
+        y = c;
+      }
+    }
+
+    if (best == kInf) {
+      // distances never decrease: no cluster of the chain can be merged
+      for (auto const c : chain) {
+        deactivate(c);
+      }
+      chain.clear();
+    } else if (y == prev) {
+      // reciprocal nearest neighbours: merge
+      chain.resize(chain.size() - 2U);
+      auto const [a, b] = std::minmax(x, y);
+      deactivate(b);
+      for (auto const c : active) {
+        if (c != a) {
+          d[idx(a, c)] = std::max(d[idx(a, c)], d[idx(b, c)]);
+        }
+      }
+      clusters[b] = a;
+    } else {
+      chain.push_back(y);
+    }
+  }
+
+  for (auto i = 0U; i < clusters.size(); ++i) {
+    clusters[i] = clusters[clusters[i]];
+  }
+  return clusters;
+}
+
+template <typename Metric>
+std::vector<cluster_id_t> complete_linkage_sparse(
+    neighbor_index<Metric> const& index) {
+  using dist_t = decltype(index.metric_(index.points_[0], index.points_[0]));
+  using neighbor_t = std::pair<cluster_id_t, dist_t>;
+  using candidate_t = std::tuple<dist_t, cluster_id_t, cluster_id_t>;
+  using queue_t = std::priority_queue<candidate_t, std::vector<candidate_t>,
+                                      std::greater<>>;
+  constexpr auto const kInf = std::numeric_limits<dist_t>::infinity();
+
+  // symmetric lists sorted by id. Entries are not erased on merges: links to
+  // merged clusters and dropped links (distance kInf) are outdated.
+  std::vector<std::vector<neighbor_t>> neighbors(index.size());
+  for (auto i = cluster_id_t{0U}; i < index.size(); ++i) {
+    index.for_each_neighbor(i, [&](cluster_id_t const j, dist_t const dist) {
+      neighbors[i].emplace_back(j, dist);
+    });
+    std::sort(begin(neighbors[i]), end(neighbors[i]));
+  }
+
+  // merged clusters point to a cluster with a smaller id
+  std::vector<cluster_id_t> clusters(index.size());
+  std::iota(begin(clusters), end(clusters), cluster_id_t{0U});
+
+  auto const is_valid = [&](neighbor_t const& n) {
+    return clusters[n.first] == n.first && n.second != kInf;
+  };
+
+  // nearest[c] = closest neighbour of c (smallest id on ties), c if none
+  std::vector<neighbor_t> nearest(index.size());
+  auto candidates = queue_t{};
+  auto const update_nearest = [&](cluster_id_t const c) {
+    auto& n = neighbors[c];
+    n.erase(std::remove_if(begin(n), end(n),
+                           [&](neighbor_t const& x) { return !is_valid(x); }),
+            end(n));
+    auto const best = std::min_element(
+        begin(n), end(n), [](neighbor_t const& x, neighbor_t const& y) {
+          return x.second < y.second;
+        });
+    if (best == end(n)) {
+      nearest[c] = neighbor_t{c, dist_t{}};
+    } else {
+      nearest[c] = *best;
+      candidates.emplace(best->second, c, best->first);
+    }
+  };
+  for (auto i = cluster_id_t{0U}; i < index.size(); ++i) {
+    update_nearest(i);
+  }
+
+  std::vector<neighbor_t> merged;
+  std::vector<cluster_id_t> affected;
+  while (!candidates.empty()) {
+    auto const [dist, a, b] = candidates.top();
+    candidates.pop();
+
+    // skip outdated candidates (lazy deletion)
+    // the first valid candidate has a < b: same merge order as a queue of
+    // all pairs (dist, min id, max id)
+    if (clusters[a] != a || nearest[a] != neighbor_t{b, dist}) {
+      continue;
+    }
+
+    // Lance-Williams update for complete linkage:
+    // d(a+b, c) = max(d(a, c), d(b, c)), only defined if both are defined
+    merged.clear();
+    affected.clear();
+    auto ia = begin(neighbors[a]);
+    auto ib = begin(neighbors[b]);
+    while (ia != end(neighbors[a]) || ib != end(neighbors[b])) {
+      if (ia != end(neighbors[a]) && !is_valid(*ia)) {
+        ++ia;
+      } else if (ib != end(neighbors[b]) && !is_valid(*ib)) {
+        ++ib;
+      } else if (ib == end(neighbors[b]) ||
+                 (ia != end(neighbors[a]) && ia->first < ib->first)) {
+        affected.push_back(ia++->first);
+      } else if (ia == end(neighbors[a]) || ib->first < ia->first) {
+        affected.push_back(ib++->first);
+      } else {
+        merged.emplace_back(ia->first, std::max(ia->second, ib->second));
+        affected.push_back(ia->first);
+        ++ia;
+        ++ib;
+      }
+    }
+
+    // links to b are outdated with clusters[b] = a, links to a are updated
+    clusters[b] = a;
+    auto m = begin(merged);
+    for (auto const& [c, d] : neighbors[a]) {
+      if (c == b || !is_valid(neighbor_t{c, d})) {
+        continue;
+      }
+      while (m != end(merged) && m->first < c) {
+        ++m;
+      }
+      auto& n = neighbors[c];
+      auto const link = std::lower_bound(
+          begin(n), end(n), a, [](neighbor_t const& x, cluster_id_t const y) {
+            return x.first < y;
+          });
+      link->second = (m != end(merged) && m->first == c) ? m->second : kInf;
+    }
+    neighbors[a].swap(merged);
+    neighbors[b] = {};
+
+    // distances to a + b are >= the distances to a and b: only clusters
+    // with a or b as nearest neighbour change
+    for (auto const c : affected) {
+      if (c != a && c != b &&
+          (nearest[c].first == a || nearest[c].first == b)) {
+        update_nearest(c);
+      }
+    }
+    update_nearest(a);
+
+    if (candidates.size() > 2U * index.size()) {
+      std::vector<candidate_t> current;
+      for (auto c = cluster_id_t{0U}; c < index.size(); ++c) {
+        if (clusters[c] == c && nearest[c].first != c) {
+          current.emplace_back(nearest[c].second, c, nearest[c].first);
+        }
+      }
+      candidates = queue_t{std::greater<>{}, std::move(current)};
+    }
+  }
+
+  for (auto i = 0U; i < clusters.size(); ++i) {
+    clusters[i] = clusters[clusters[i]];
+  }
+  return clusters;
+}
+
+}  // namespace detail
+
+template <typename Metric>
+std::vector<cluster_id_t> make_complete_linkage_clusters(
+    neighbor_index<Metric> const& index,
+    std::size_t const max_matrix_bytes = kCompleteLinkageMaxMatrixBytes) {
+  using dist_t = decltype(index.metric_(index.points_[0], index.points_[0]));
+  auto const n = index.size();
+  if (n < 2U) {
+    return std::vector<cluster_id_t>(n, cluster_id_t{0U});
+  }
+
+  auto const matrix_bytes = n * (n - 1U) / 2U * sizeof(dist_t);
+  if (matrix_bytes <= max_matrix_bytes) {
+    return detail::complete_linkage_nn_chain(index);
+  }
+
+  auto pairs = std::size_t{0U};
+  for (auto i = cluster_id_t{0U}; i < n; ++i) {
+    index.for_each_neighbor(
+        i, [&](cluster_id_t const j, auto) { pairs += i < j ? 1U : 0U; });
+  }
+  auto const list_bytes =
+      2U * pairs * sizeof(std::pair<cluster_id_t, dist_t>);
+  return matrix_bytes <= list_bytes ? detail::complete_linkage_nn_chain(index)
+                                    : detail::complete_linkage_sparse(index);
+}
+
+// Weighted DBSCAN: a point is a core point if the summed weight of all points
+// within max_dist (including itself) is >= min_weight. Clusters are the
+// connected components of core points plus their border points.
+// Cluster id = smallest core point index, noise = NO_CLUSTER.
+template <typename Metric, typename Weights>
+std::vector<cluster_id_t> make_dbscan_clusters(
+    neighbor_index<Metric> const& index, double const min_weight,
+    Weights const& weights) {
+  std::vector<bool> is_core(index.size());
+  for (auto i = cluster_id_t{0U}; i < index.size(); ++i) {
+    auto weight = static_cast<double>(weights[i]);
+    index.for_each_neighbor(
+        i, [&](cluster_id_t const j, auto) { weight += weights[j]; });
+    is_core[i] = weight >= min_weight;
+  }
+
+  std::vector<cluster_id_t> clusters(index.size(), NO_CLUSTER);
+  std::vector<cluster_id_t> stack;
+  for (auto i = cluster_id_t{0U}; i < index.size(); ++i) {
+    if (!is_core[i] || clusters[i] != NO_CLUSTER) {
+      continue;
+    }
+
+    clusters[i] = i;
+    stack = {i};
+    while (!stack.empty()) {
+      auto const x = stack.back();
+      stack.pop_back();
+      index.for_each_neighbor(x, [&](cluster_id_t const j, auto) {
+        if (clusters[j] != NO_CLUSTER) {
+          return;
+        }
+        clusters[j] = i;
+        if (is_core[j]) {
+          stack.push_back(j);
+        }
+      });
+    }
+  }
+  return clusters;
+}
+
+// DBSCAN with unit weights: core points have >= min_points points within
+// max_dist (including itself).
+template <typename Metric>
+std::vector<cluster_id_t> make_dbscan_clusters(
+    neighbor_index<Metric> const& index, std::size_t const min_points) {
+  struct unit_weights {
+    double operator[](std::size_t) const { return 1.0; }
+  };
+  return make_dbscan_clusters(index, static_cast<double>(min_points),
+                              unit_weights{});
+}
+
+}  // namespace geo
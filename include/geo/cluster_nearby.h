@@ -10,7 +10,9 @@ namespace geo {
 using cluster_id_t = uint32_t;
 constexpr cluster_id_t NO_CLUSTER = std::numeric_limits<cluster_id_t>::max();
 
+// Complete linkage clusters (all members within max_dist meters).
+// parallel: refine independent single linkage components concurrently.
 std::vector<cluster_id_t> cluster_nearby(std::vector<latlng> const& coords,
-                                         float max_dist);
+                                         float max_dist, bool parallel = false);
 
 }  // namespace geo
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "geo/fixed_geometry.h"
+#include "geo/fixed_latlng.h"
+#include "geo/latlng.h"
+
+// Compressed storage for many polylines (e.g. route shapes), usable with
+// memory mapped vectors (like area_db_storage).
+//
+// Every polyline is split into blocks of kBlockSize points. A block is a
+// bit stream: absolute anchor point (2 x 32 bit), bit widths of the lat / lng
+// deltas (2 x 6 bit), then the zigzag encoded deltas to the predecessor
+// packed with these widths. Dense shapes (points a few meters apart) need
+// around 3 bytes per point instead of 8 for fixed_latlng.
+//
+// Blocks decode independently: random access decodes at most one block.
+
+namespace geo {
+
+namespace detail {
+
+constexpr auto const kCompressedPolylineBlockSize = 64U;
+
+// bytes after the last block, so that every read can load 8 bytes
+constexpr auto const kCompressedPolylinePadding = 8U;
+
+// little endian, compiles to a single load on little endian targets
+inline std::uint64_t load_le64(std::uint8_t const* p) {
+  auto v = std::uint64_t{0U};
+  for (auto i = 0U; i != 8U; ++i) {
+    v |= static_cast<std::uint64_t>(p[i]) << (8U * i);
+  }
+  return v;
+}
+
+// width <= 32
+inline std::uint32_t read_bits(std::uint8_t const* data,
+                               std::uint64_t const bit_pos,
+                               unsigned const width) {
+  auto const word = load_le64(data + (bit_pos >> 3U)) >> (bit_pos & 7U);
+  return static_cast<std::uint32_t>(word &
+                                    ((std::uint64_t{1U} << width) - 1U));
+}
+
+struct bit_writer {
+  // width <= 32
+  void write(std::uint32_t const value, unsigned const width) {
+    acc_ |= static_cast<std::uint64_t>(value) << n_bits_;
+    n_bits_ += width;
+    while (n_bits_ >= 8U) {
+      out_.push_back(static_cast<std::uint8_t>(acc_));
+      acc_ >>= 8U;
+      n_bits_ -= 8U;
+    }
+  }
+
+  void flush() {
+    if (n_bits_ != 0U) {
+      out_.push_back(static_cast<std::uint8_t>(acc_));
+    }
+    acc_ = 0U;
+    n_bits_ = 0U;
+  }
+
+  std::vector<std::uint8_t>& out_;
+  std::uint64_t acc_{0U};
+  unsigned n_bits_{0U};
+};
+
+inline unsigned bit_width32(std::uint32_t x) {
+  auto width = 0U;
+  for (; x != 0U; x >>= 1U) {
+    ++width;
+  }
+  return width;
+}
+
+// n points starting at first (n <= kCompressedPolylineBlockSize)
+inline void encode_block(fixed_latlng const* first, std::size_t const n,
+                         std::vector<std::uint8_t>& out) {
+  auto width_lat = 0U;
+  auto width_lng = 0U;
+  for (auto i = std::size_t{1U}; i < n; ++i) {
+    width_lat = std::max(width_lat, bit_width32(zigzag32(wrapping_sub(
+                                        first[i].lat_, first[i - 1U].lat_))));
+    width_lng = std::max(width_lng, bit_width32(zigzag32(wrapping_sub(
+                                        first[i].lng_, first[i - 1U].lng_))));
+  }
+
+  auto w = bit_writer{out};
+  w.write(static_cast<std::uint32_t>(first[0].lat_), 32U);
+  w.write(static_cast<std::uint32_t>(first[0].lng_), 32U);
+  w.write(width_lat, 6U);
+  w.write(width_lng, 6U);
+  for (auto i = std::size_t{1U}; i < n; ++i) {
+    w.write(zigzag32(wrapping_sub(first[i].lat_, first[i - 1U].lat_)),
+            width_lat);
+    w.write(zigzag32(wrapping_sub(first[i].lng_, first[i - 1U].lng_)),
+            width_lng);
+  }
+  w.flush();
+}
+
+// Decodes the points [0, n) of the block at data into out.
+inline void decode_block(std::uint8_t const* data, std::size_t const n,
+                         fixed_latlng* out) {
+  auto lat = static_cast<std::int32_t>(read_bits(data, 0U, 32U));
+  auto lng = static_cast<std::int32_t>(read_bits(data, 32U, 32U));
+  auto const width_lat = read_bits(data, 64U, 6U);
+  auto const width_lng = read_bits(data, 70U, 6U);
+
+  out[0] = fixed_latlng{lat, lng};
+  auto bit_pos = std::uint64_t{76U};
+  for (auto i = std::size_t{1U}; i < n; ++i) {
+    lat = wrapping_add(lat, unzigzag32(read_bits(data, bit_pos, width_lat)));
+    bit_pos += width_lat;
+    lng = wrapping_add(lng, unzigzag32(read_bits(data, bit_pos, width_lng)));
+    bit_pos += width_lng;
+    out[i] = fixed_latlng{lat, lng};
+  }
+}
+
+}  // namespace detail
+
+// View on one polyline of compressed_polylines.
+struct compressed_polyline {
+  static constexpr auto const kBlockSize =
+      detail::kCompressedPolylineBlockSize;
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0U; }
+  std::size_t n_blocks() const {
+    return (size_ + kBlockSize - 1U) / kBlockSize;
+  }
+
+  std::size_t block_size(std::size_t const block) const {
+    return std::min(std::size_t{kBlockSize}, size_ - block * kBlockSize);
+  }
+
+  // writes block_size(block) points to out
+  void decode_block(std::size_t const block, fixed_latlng* out) const {
+    detail::decode_block(data_ + block_offsets_[block], block_size(block),
+                         out);
+  }
+
+  // replaces the contents of out (reusing its capacity)
+  void decode(std::vector<fixed_latlng>& out) const {
+    out.resize(size_);
+    for (auto b = std::size_t{0U}; b != n_blocks(); ++b) {
+      decode_block(b, out.data() + b * kBlockSize);
+    }
+  }
+
+  std::vector<fixed_latlng> decode() const {
+    auto out = std::vector<fixed_latlng>{};
+    decode(out);
+    return out;
+  }
+
+  // random access: decodes the block prefix up to i
+  fixed_latlng operator[](std::size_t const i) const {
+    fixed_latlng buf[kBlockSize];
+    auto const block = i / kBlockSize;
+    detail::decode_block(data_ + block_offsets_[block], i % kBlockSize + 1U,
+                         buf);
+    return buf[i % kBlockSize];
+  }
+
+  std::uint8_t const* data_;
+  std::uint64_t const* block_offsets_;  // byte offsets of the blocks in data_
+  std::size_t size_;
+};
+
+// Storage: std::vector or memory mapped vectors (e.g. cista mmap_vec) with
+// size(), resize(), data(), operator[] and push_back().
+template <typename IdxVec = std::vector<std::uint64_t>,
+          typename DataVec = std::vector<std::uint8_t>>
+struct compressed_polylines {
+  static constexpr auto const kBlockSize =
+      detail::kCompressedPolylineBlockSize;
+
+  compressed_polylines() = default;
+
+  compressed_polylines(IdxVec point_idx, IdxVec first_block,
+                       IdxVec block_offsets, DataVec data)
+      : point_idx_{std::move(point_idx)},
+        first_block_{std::move(first_block)},
+        block_offsets_{std::move(block_offsets)},
+        data_{std::move(data)} {}
+
+  // any range of fixed_latlng or latlng
+  template <typename Polyline>
+  void emplace_back(Polyline const& line) {
+    if (point_idx_.size() == 0U) {
+      point_idx_.push_back(0U);
+      first_block_.push_back(0U);
+    }
+
+    tmp_points_.clear();
+    for (auto const& p : line) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(p)>, latlng>) {
+        tmp_points_.push_back(fixed_latlng::from_latlng(p));
+      } else {
+        tmp_points_.push_back(p);
+      }
+    }
+
+    // new blocks overwrite the padding
+    auto const offset = data_.size() == 0U
+                            ? std::uint64_t{0U}
+                            : static_cast<std::uint64_t>(data_.size()) -
+                                  detail::kCompressedPolylinePadding;
+    tmp_bytes_.clear();
+    for (auto i = std::size_t{0U}; i < tmp_points_.size(); i += kBlockSize) {
+      block_offsets_.push_back(offset + tmp_bytes_.size());
+      detail::encode_block(
+          tmp_points_.data() + i,
+          std::min(std::size_t{kBlockSize}, tmp_points_.size() - i),
+          tmp_bytes_);
+    }
+    tmp_bytes_.resize(tmp_bytes_.size() + detail::kCompressedPolylinePadding);
+
+    data_.resize(offset + tmp_bytes_.size());
+    std::memcpy(data_.data() + offset, tmp_bytes_.data(), tmp_bytes_.size());
+
+    point_idx_.push_back(point_idx_[point_idx_.size() - 1U] +
+                         tmp_points_.size());
+    first_block_.push_back(block_offsets_.size());
+  }
+
+  std::size_t size() const {
+    return point_idx_.size() == 0U ? 0U : point_idx_.size() - 1U;
+  }
+
+  compressed_polyline operator[](std::size_t const i) const {
+    return {reinterpret_cast<std::uint8_t const*>(data_.data()),
+            block_offsets_.data() + first_block_[i],
+            static_cast<std::size_t>(point_idx_[i + 1U] - point_idx_[i])};
+  }
+
+  // total encoded size including the index
+  std::size_t size_in_bytes() const {
+    return data_.size() +
+           (point_idx_.size() + first_block_.size() + block_offsets_.size()) *
+               sizeof(std::uint64_t);
+  }
+
+  IdxVec point_idx_;  // polyline i: points [point_idx_[i], point_idx_[i+1])
+  IdxVec first_block_;  // polyline i: blocks [first_block_[i], [i + 1])
+  IdxVec block_offsets_;  // byte offset of every block in data_
+  DataVec data_;
+
+private:
+  std::vector<fixed_latlng> tmp_points_;
+  std::vector<std::uint8_t> tmp_bytes_;
+};
+
+}  // namespace geo
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "geo/constants.h"
+
+// Branch free polynomial approximations without library calls, so loops over
+// arrays can be vectorized by the compiler. Selects use bit masks: conditional
+// floating point operations are not if-converted with -ftrapping-math.
+// Maximum errors (checked in webmercator_batch_test):
+//   - fast_sin:  |x| <= pi/2, absolute error < 1e-15
+//   - fast_log:  normal x > 0, relative error < 1e-15
+//   - fast_exp:  |x| <= 700, relative error < 1e-15
+//   - fast_atan: |x| <= 1, absolute error < 1e-15
+
+namespace geo {
+
+namespace detail {
+
+inline double bits_to_double(std::uint64_t const bits) {
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+inline std::uint64_t double_to_bits(double const d) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(d));
+  return bits;
+}
+
+// c ? a : b, as bit mask (no branch the compiler could reintroduce)
+inline double select(bool const c, double const a, double const b) {
+  auto const mask = std::uint64_t{0U} - static_cast<std::uint64_t>(c);
+  return bits_to_double((double_to_bits(a) & mask) |
+                        (double_to_bits(b) & ~mask));
+}
+
+inline double branch_free_clamp(double const x, double const lo,
+                                double const hi) {
+  return select(x < lo, lo, select(x > hi, hi, x));
+}
+
+constexpr auto const kLn2Hi = 6.93147180369123816490e-01;
+constexpr auto const kLn2Lo = 1.90821492927058770002e-10;
+
+// integer <-> double conversion without 64 bit integer conversion
+// instructions (not available in AVX2)
+constexpr auto const kTwoPow52 = 4503599627370496.0;
+constexpr auto const kTwoPow52Bits = std::uint64_t{0x4330000000000000ULL};
+constexpr auto const kRoundMagic = 6755399441055744.0;  // 1.5 * 2^52
+
+// Taylor series up to x^21
+inline double fast_sin(double const x) {
+  auto const x2 = x * x;
+  auto p = 1.0 / 51090942171709440000.0;
+  p = p * x2 - 1.0 / 121645100408832000.0;
+  p = p * x2 + 1.0 / 355687428096000.0;
+  p = p * x2 - 1.0 / 1307674368000.0;
+  p = p * x2 + 1.0 / 6227020800.0;
+  p = p * x2 - 1.0 / 39916800.0;
+  p = p * x2 + 1.0 / 362880.0;
+  p = p * x2 - 1.0 / 5040.0;
+  p = p * x2 + 1.0 / 120.0;
+  p = p * x2 - 1.0 / 6.0;
+  return x + x * x2 * p;
+}
+
+// x = m * 2^e with m in [sqrt(1/2), sqrt(2)),
+// log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), |s| < 0.172
+inline double fast_log(double const x) {
+  auto const bits = double_to_bits(x);
+  auto const m_1_2 =
+      bits_to_double((bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+  auto const biased_e =
+      bits_to_double((bits >> 52U) | kTwoPow52Bits) - kTwoPow52;
+  auto const shift = select(m_1_2 > 1.4142135623730951, 1.0, 0.0);
+  auto const m = m_1_2 * (1.0 - 0.5 * shift);
+  auto const e = biased_e - 1023.0 + shift;
+
+  auto const s = (m - 1.0) / (m + 1.0);
+  auto const s2 = s * s;
+  auto p = 1.0 / 21.0;
+  p = p * s2 + 1.0 / 19.0;
+  p = p * s2 + 1.0 / 17.0;
+  p = p * s2 + 1.0 / 15.0;
+  p = p * s2 + 1.0 / 13.0;
+  p = p * s2 + 1.0 / 11.0;
+  p = p * s2 + 1.0 / 9.0;
+  p = p * s2 + 1.0 / 7.0;
+  p = p * s2 + 1.0 / 5.0;
+  p = p * s2 + 1.0 / 3.0;
+  return e * kLn2Hi + (e * kLn2Lo + 2.0 * s * s2 * p + 2.0 * s);
+}
+
+// exp(x) = 2^k * exp(r), |r| <= ln(2) / 2, Taylor series up to r^13
+inline double fast_exp(double const x) {
+  // k is stored in the lowest mantissa bits of k_shifted
+  auto const k_shifted = x * 1.4426950408889634 + kRoundMagic;
+  auto const k = k_shifted - kRoundMagic;
+  auto const r = (x - k * kLn2Hi) - k * kLn2Lo;
+  auto p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+  return p * bits_to_double((double_to_bits(k_shifted) + 1023U) << 52U);
+}
+
+// |x| > tan(pi/8): atan(x) = pi/4 + atan((x - 1) / (x + 1)),
+// Taylor series up to t^39 for |t| <= tan(pi/8)
+inline double fast_atan(double const x) {
+  auto const a = std::abs(x);
+  auto const shift = select(a > 0.41421356237309503, 1.0, 0.0);
+  auto const t = (a - shift) / (a * shift + 1.0);
+  auto const t2 = t * t;
+  auto p = 1.0 / 39.0;
+  p = p * t2 - 1.0 / 37.0;
+  p = p * t2 + 1.0 / 35.0;
+  p = p * t2 - 1.0 / 33.0;
+  p = p * t2 + 1.0 / 31.0;
+  p = p * t2 - 1.0 / 29.0;
+  p = p * t2 + 1.0 / 27.0;
+  p = p * t2 - 1.0 / 25.0;
+  p = p * t2 + 1.0 / 23.0;
+  p = p * t2 - 1.0 / 21.0;
+  p = p * t2 + 1.0 / 19.0;
+  p = p * t2 - 1.0 / 17.0;
+  p = p * t2 + 1.0 / 15.0;
+  p = p * t2 - 1.0 / 13.0;
+  p = p * t2 + 1.0 / 11.0;
+  p = p * t2 - 1.0 / 9.0;
+  p = p * t2 + 1.0 / 7.0;
+  p = p * t2 - 1.0 / 5.0;
+  p = p * t2 + 1.0 / 3.0;
+  auto const r = shift * (kPI / 4.0) + (t - t * t2 * p);
+  return std::copysign(r, x);
+}
+
+}  // namespace detail
+
+}  // namespace geo
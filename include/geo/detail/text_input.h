@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdlib>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "cista/mmap.h"
+
+namespace geo {
+
+namespace detail {
+
+// read-only memory mapping of the whole file, view() is parsed in place
+inline cista::mmap map_file(std::string const& filename) {
+  return cista::mmap{filename.c_str(), cista::mmap::protection::READ};
+}
+
+inline bool is_space(char const c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline void skip_spaces(char const*& first, char const* last) {
+  while (first != last && is_space(*first)) {
+    ++first;
+  }
+}
+
+// Parses a floating point number at first and advances first behind it.
+// Throws if there is no number.
+inline double parse_double(char const*& first, char const* last) {
+  auto value = 0.0;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  // from_chars does not accept a leading '+'
+  auto const begin = first != last && *first == '+' ? first + 1 : first;
+  auto const [ptr, ec] = std::from_chars(begin, last, value);
+  if (ec != std::errc{}) {
+    throw std::runtime_error{"invalid number: " +
+                             std::string{first, std::min(last, first + 32)}};
+  }
+  first = ptr;
+#else
+  // strtod needs a terminated string
+  char buf[64];
+  auto const n = std::min(static_cast<std::size_t>(last - first),
+                          sizeof(buf) - 1U);
+  std::copy(first, first + n, buf);
+  buf[n] = '\0';
+  char* end = nullptr;
+  value = std::strtod(buf, &end);
+  if (end == buf) {
+    throw std::runtime_error{"invalid number: " + std::string{buf}};
+  }
+  first += end - buf;
+#endif
+  return value;
+}
+
+}  // namespace detail
+
+}  // namespace geo
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "geo/latlng.h"
+#include "geo/xyz.h"
+
+namespace geo {
+
+// Batched one-to-many and many-to-many distance kernels over structure of
+// arrays (SoA) coordinates. AVX2 / AVX-512 code paths are used if enabled at
+// compile time (e.g. -march=native), otherwise a scalar loop.
+//
+// Accuracy:
+//   - chord / haversine: same formula as haversine_distance(xyz, xyz), results
+//     differ by a few ulp at most (FMA contraction). Absolute deviation from
+//     geo::distance is below 1e-6 meters.
+//   - equirectangular: same formula as distance<kEquirectangular> (longitude
+//     scaled at the mean latitude), results differ by a few ulp at most.
+
+struct xyz_soa {
+  xyz_soa() = default;
+
+  // any container of latlng / fixed_latlng
+  template <typename Coords>
+  explicit xyz_soa(Coords const& coords) {
+    reserve(coords.size());
+    for (auto const& c : coords) {
+      push_back(xyz{static_cast<latlng>(c)});
+    }
+  }
+
+  void push_back(xyz const& p) {
+    x_.push_back(p.x_);
+    y_.push_back(p.y_);
+    z_.push_back(p.z_);
+  }
+
+  void reserve(std::size_t const n) {
+    x_.reserve(n);
+    y_.reserve(n);
+    z_.reserve(n);
+  }
+
+  std::size_t size() const { return x_.size(); }
+  xyz operator[](std::size_t const i) const { return xyz{x_[i], y_[i], z_[i]}; }
+
+  std::vector<double> x_, y_, z_;
+};
+
+struct latlng_soa {
+  latlng_soa() = default;
+
+  // any container of latlng / fixed_latlng
+  template <typename Coords>
+  explicit latlng_soa(Coords const& coords) {
+    reserve(coords.size());
+    for (auto const& c : coords) {
+      push_back(static_cast<latlng>(c));
+    }
+  }
+
+  void push_back(latlng const& p) {
+    lat_.push_back(p.lat_);
+    lng_.push_back(p.lng_);
+  }
+
+  void reserve(std::size_t const n) {
+    lat_.reserve(n);
+    lng_.reserve(n);
+  }
+
+  std::size_t size() const { return lat_.size(); }
+  latlng operator[](std::size_t const i) const { return {lat_[i], lng_[i]}; }
+
+  std::vector<double> lat_, lng_;
+};
+
+// squared chord length in xyz units (radius 0.5, see xyz.h)
+void chord_squared_distances(xyz const&, xyz_soa const&,
+                             std::vector<double>& out);
+
+// great circle distance in meters
+void haversine_distances(xyz const&, xyz_soa const&, std::vector<double>& out);
+
+// row major: out[i * b.size() + j] = distance(a[i], b[j])
+void haversine_distances(xyz_soa const& a, xyz_soa const& b,
+                         std::vector<double>& out);
+
+// {distance in meters, index}, {infinity, 0} if empty
+std::pair<double, std::size_t> nearest(xyz const&, xyz_soa const&);
+
+// equirectangular approximation in meters
+void equirectangular_distances(latlng const&, latlng_soa const&,
+                               std::vector<double>& out);
+
+// row major: out[i * b.size() + j] = distance(a[i], b[j])
+void equirectangular_distances(latlng_soa const& a, latlng_soa const& b,
+                               std::vector<double>& out);
+
+}  // namespace geo
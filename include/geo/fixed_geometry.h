@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cinttypes>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "geo/box.h"
+#include "geo/constants.h"
+#include "geo/fixed_latlng.h"
+
+// Integer kernels on fixed_latlng (1e-7 degrees), e.g. for memory mapped
+// coordinates: no conversion to double, exact predicates (int64 arithmetic).
+
+namespace geo {
+
+namespace detail {
+
+// wrapping difference: b - a + a == b for every pair of int32 values
+constexpr std::int32_t wrapping_sub(std::int32_t const b,
+                                    std::int32_t const a) {
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(b) -
+                                   static_cast<std::uint32_t>(a));
+}
+
+constexpr std::int32_t wrapping_add(std::int32_t const a,
+                                    std::int32_t const b) {
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(a) +
+                                   static_cast<std::uint32_t>(b));
+}
+
+constexpr std::uint32_t zigzag32(std::int32_t const x) {
+  return (static_cast<std::uint32_t>(x) << 1) ^
+         static_cast<std::uint32_t>(x < 0 ? ~std::int32_t{0} : std::int32_t{0});
+}
+
+constexpr std::int32_t unzigzag32(std::uint32_t const x) {
+  return static_cast<std::int32_t>(x >> 1) ^ -static_cast<std::int32_t>(x & 1U);
+}
+
+// Does the edge a -> b cross the ray from p towards increasing longitude?
+// Half-open in latitude: [min(a, b), max(a, b)), exact.
+// Precondition: valid coordinates (|lat| <= 90, |lng| <= 180 degrees).
+inline bool crosses_ray(fixed_latlng const& p, fixed_latlng const& a,
+                        fixed_latlng const& b) {
+  if ((a.lat_ > p.lat_) == (b.lat_ > p.lat_)) {
+    return false;
+  }
+
+  // p left of the crossing: (p - a).lng * d.lat < (p - a).lat * d.lng
+  // (for valid coordinates |d.lat| <= 1.8e9 and |d.lng| <= 3.6e9, so both
+  // products fit into int64; comparing instead of subtracting. Arbitrary
+  // int32 values can overflow.)
+  auto const lhs =
+      (std::int64_t{p.lng_} - a.lng_) * (std::int64_t{b.lat_} - a.lat_);
+  auto const rhs =
+      (std::int64_t{p.lat_} - a.lat_) * (std::int64_t{b.lng_} - a.lng_);
+  return b.lat_ > a.lat_ ? lhs < rhs : lhs > rhs;
+}
+
+}  // namespace detail
+
+struct fixed_box {
+  fixed_box()
+      : min_{std::numeric_limits<std::int32_t>::max(),
+             std::numeric_limits<std::int32_t>::max()},
+        max_{std::numeric_limits<std::int32_t>::min(),
+             std::numeric_limits<std::int32_t>::min()} {}
+
+  fixed_box(fixed_latlng const& min, fixed_latlng const& max)
+      : min_{min}, max_{max} {}
+
+  // any range of fixed_latlng
+  template <typename Coords>
+  static fixed_box of(Coords const& coords) {
+    auto b = fixed_box{};
+    for (auto const& c : coords) {
+      b.extend(c);
+    }
+    return b;
+  }
+
+  void extend(fixed_latlng const& pos) {
+    min_.lat_ = std::min(min_.lat_, pos.lat_);
+    min_.lng_ = std::min(min_.lng_, pos.lng_);
+    max_.lat_ = std::max(max_.lat_, pos.lat_);
+    max_.lng_ = std::max(max_.lng_, pos.lng_);
+  }
+
+  void extend(fixed_box const& other) {
+    extend(other.min_);
+    extend(other.max_);
+  }
+
+  // including the boundary (unlike box::contains)
+  bool contains(fixed_latlng const& pos) const {
+    return pos.lat_ >= min_.lat_ && pos.lat_ <= max_.lat_ &&
+           pos.lng_ >= min_.lng_ && pos.lng_ <= max_.lng_;
+  }
+
+  bool overlaps(fixed_box const& b) const {
+    return min_.lat_ <= b.max_.lat_ && max_.lat_ >= b.min_.lat_ &&
+           min_.lng_ <= b.max_.lng_ && max_.lng_ >= b.min_.lng_;
+  }
+
+  bool empty() const { return max_.lat_ < min_.lat_ || max_.lng_ < min_.lng_; }
+
+  box to_box() const { return empty() ? box{} : box{min_, max_}; }
+
+  friend bool operator==(fixed_box const& a, fixed_box const& b) {
+    return a.min_ == b.min_ && a.max_ == b.max_;
+  }
+
+  fixed_latlng min_, max_;
+};
+
+// Crossing number test with exact integer arithmetic. Ring: any random
+// access range of fixed_latlng, closing edge (last -> first) is implicit.
+// Edges are straight lines in lat/lng (geo::within: great circle arcs).
+// Precondition: valid coordinates (see detail::crosses_ray).
+//
+// Points on the boundary are decided consistently (half-open rule): of two
+// rings sharing an edge, at most one contains a point on that edge.
+template <typename Ring>
+bool within(fixed_latlng const& p, Ring const& ring) {
+  auto const n = static_cast<std::size_t>(std::size(ring));
+  if (n < 3U) {
+    return false;
+  }
+
+  auto inside = false;
+  auto prev = static_cast<fixed_latlng>(ring[n - 1U]);
+  for (auto i = std::size_t{0U}; i != n; ++i) {
+    auto const curr = static_cast<fixed_latlng>(ring[i]);
+    inside ^= detail::crosses_ray(p, prev, curr);
+    prev = curr;
+  }
+  return inside;
+}
+
+// Equirectangular squared distances in fixed units (1e-7 degrees latitude),
+// longitude differences are scaled by cos(lat) of a reference latitude.
+// Meant for comparisons (nearest candidate, radius checks): relative error
+// below 0.5% for distances < 10km and |lat| <= 80 degrees.
+struct fixed_distance_approx {
+  static constexpr auto const kScaleBits = 16U;
+  static constexpr auto const kHalfTurn =
+      std::int64_t{180} * fixed_latlng::kCoordinatePrecision;
+
+  explicit fixed_distance_approx(double const ref_lat)
+      : lng_scale_{static_cast<std::int64_t>(
+            std::round(std::cos(ref_lat * (kPI / 180.0)) *
+                       static_cast<double>(std::int64_t{1} << kScaleBits)))} {}
+
+  static fixed_distance_approx at(fixed_latlng const& ref) {
+    return fixed_distance_approx{ref.lat()};
+  }
+
+  static std::uint64_t squared_from_meters(double const meters) {
+    auto const fixed = meters / kApproxDistanceLatDegrees *
+                       fixed_latlng::kCoordinatePrecision;
+    return static_cast<std::uint64_t>(fixed * fixed);
+  }
+
+  double to_meters(std::uint64_t const squared) const {
+    return std::sqrt(static_cast<double>(squared)) /
+           fixed_latlng::kCoordinatePrecision * kApproxDistanceLatDegrees;
+  }
+
+  // shortest way around the antimeridian
+  std::uint64_t squared_distance(fixed_latlng const& a,
+                                 fixed_latlng const& b) const {
+    auto const d_lat = std::int64_t{a.lat_} - b.lat_;
+    auto d_lng = std::int64_t{a.lng_} - b.lng_;
+    d_lng = d_lng < 0 ? -d_lng : d_lng;
+    d_lng = d_lng > kHalfTurn ? 2 * kHalfTurn - d_lng : d_lng;
+    auto const scaled_lng = (d_lng * lng_scale_) >> kScaleBits;
+    return static_cast<std::uint64_t>(d_lat * d_lat) +
+           static_cast<std::uint64_t>(scaled_lng * scaled_lng);
+  }
+
+  std::int64_t lng_scale_;  // cos(ref_lat) * 2^kScaleBits
+};
+
+// Delta encoding: first coordinate absolute, then differences to the
+// predecessor. Wrapping arithmetic, so every input round trips exactly.
+template <typename Coords>
+void delta_encode(Coords const& coords, std::vector<fixed_latlng>& out) {
+  out.clear();
+  out.reserve(static_cast<std::size_t>(std::size(coords)));
+  auto prev = fixed_latlng{0, 0};
+  for (auto const& c : coords) {
+    out.push_back({detail::wrapping_sub(c.lat_, prev.lat_),
+                   detail::wrapping_sub(c.lng_, prev.lng_)});
+    prev = c;
+  }
+}
+
+// in place (prefix sum)
+inline void delta_decode(std::vector<fixed_latlng>& deltas) {
+  auto prev = fixed_latlng{0, 0};
+  for (auto& d : deltas) {
+    d = {detail::wrapping_add(prev.lat_, d.lat_),
+         detail::wrapping_add(prev.lng_, d.lng_)};
+    prev = d;
+  }
+}
+
+}  // namespace geo
@@ -26,6 +26,14 @@ struct fixed_latlng {
 
   operator latlng() const { return {lat(), lng()}; }
 
+  friend bool operator==(fixed_latlng const& a, fixed_latlng const& b) {
+    return a.lat_ == b.lat_ && a.lng_ == b.lng_;
+  }
+
+  friend bool operator!=(fixed_latlng const& a, fixed_latlng const& b) {
+    return !(a == b);
+  }
+
   std::int32_t lat_, lng_;
 };
 
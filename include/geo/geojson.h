@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "geo/polygon.h"
+
+namespace geo {
+
+// Polygons of all Polygon / MultiPolygon geometries in a GeoJSON document
+// (geometry objects, features, feature collections, geometry collections).
+// Single pass over the input without building a DOM: strings are not
+// copied, only the coordinates are materialized. Other geometries and all
+// properties are skipped. Throws std::runtime_error on malformed input.
+multi_polygon parse_geojson_polygons(std::string_view);
+multi_polygon read_geojson_polygons(std::string const& filename);
+
+}  // namespace geo
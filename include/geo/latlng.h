@@ -2,11 +2,15 @@
 
 #include <cmath>
 #include <cstdint>
+#include <algorithm>
 #include <array>
 #include <iosfwd>
 #include <limits>
 #include <tuple>
 
+#include "geo/constants.h"
+#include "geo/rad_deg.h"
+
 namespace geo {
 
 struct latlng {
@@ -34,8 +38,56 @@ struct latlng {
   double lat_{0.0}, lng_{0.0};
 };
 
+// great circle distance in meters (haversine)
 double distance(latlng const&, latlng const&);
 
+// Accuracy tiers for distance<T>(a, b) in meters:
+//   - kEquirectangular: flat earth approximation at the mean latitude,
+//     relative error < 0.1% below 10km (outside of the polar regions)
+//   - kChord: straight line through the earth (ECEF chord), shorter than the
+//     great circle distance by < 0.1% below 100km, no trigonometric inverse
+//   - kHaversine: great circle distance on a sphere (same as distance(a, b))
+//   - kVincenty: geodesic distance on the WGS84 ellipsoid (sub-millimeter),
+//     error of the sphere is up to ~0.5%
+enum class distance_type { kEquirectangular, kChord, kHaversine, kVincenty };
+
+namespace detail {
+
+// sin^2(theta / 2), theta = central angle
+inline double haversine_term(latlng const& a, latlng const& b) {
+  auto const sin_d_lat = std::sin(to_rad(b.lat_ - a.lat_) / 2.0);
+  auto const sin_d_lng = std::sin(to_rad(b.lng_ - a.lng_) / 2.0);
+  return sin_d_lat * sin_d_lat + std::cos(to_rad(a.lat_)) *
+                                     std::cos(to_rad(b.lat_)) * sin_d_lng *
+                                     sin_d_lng;
+}
+
+}  // namespace detail
+
+double vincenty_distance(latlng const&, latlng const&);
+
+template <distance_type T>
+double distance(latlng const& a, latlng const& b) {
+  if constexpr (T == distance_type::kEquirectangular) {
+    auto d_lng = std::abs(a.lng_ - b.lng_);
+    if (d_lng > 180.0) {
+      d_lng = 360.0 - d_lng;
+    }
+    auto const x = to_rad(d_lng) * std::cos(to_rad(a.lat_ + b.lat_) / 2.0);
+    auto const y = to_rad(a.lat_ - b.lat_);
+    return kEarthRadiusMeters * std::sqrt(x * x + y * y);
+  } else if constexpr (T == distance_type::kChord) {
+    return 2.0 * kEarthRadiusMeters *
+           std::sqrt(detail::haversine_term(a, b));
+  } else if constexpr (T == distance_type::kHaversine) {
+    return 2.0 * kEarthRadiusMeters *
+           std::asin(std::min(std::sqrt(detail::haversine_term(a, b)), 1.0));
+  } else {
+    static_assert(T == distance_type::kVincenty);
+    return vincenty_distance(a, b);
+  }
+}
+
 double approx_squared_distance(latlng const&, latlng const&,
                                double approx_distance_lng_degrees);
 
@@ -57,7 +109,9 @@ double approx_distance_lng_degrees(latlng const&);
 latlng destination_point(latlng const& source, double const distance,
                          double const bearing);
 
+// Morton code of the z16 / z32 tile containing the position (see tile_id)
 uint32_t tile_hash_32(latlng const&);
+uint64_t tile_hash_64(latlng const&);
 
 }  // namespace geo
 
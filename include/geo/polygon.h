@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "geo/latlng.h"
@@ -9,6 +10,23 @@ namespace geo {
 
 using simple_polygon = std::vector<latlng>;
 
+// outer ring with holes (rings as in the input, closing point if present)
+struct polygon {
+  simple_polygon outer_;
+  std::vector<simple_polygon> inners_;
+};
+
+using multi_polygon = std::vector<polygon>;
+
+// Osmosis .poly: every section is an outer ring, sections starting with '!'
+// are holes (assigned to the outer ring containing them, dropped if there is
+// none). Throws std::runtime_error on malformed input.
+multi_polygon parse_poly(std::string_view);
+multi_polygon read_poly(std::string const& filename);
+
+// First ring of the .poly file. Lenient, unlike read_poly: the ring ends at
+// the first line that is not indented, END is optional and the rest of the
+// file is ignored. Throws if an indented line has no two numbers.
 simple_polygon read_poly_file(std::string const& filename);
 
 bool within(latlng const&, simple_polygon const&);
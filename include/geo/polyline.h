@@ -7,6 +7,7 @@
 #include "utl/pairwise.h"
 
 #include "geo/latlng.h"
+#include "geo/webmercator.h"
 
 namespace geo {
 
@@ -16,26 +17,31 @@ double length(polyline const&);
 
 polyline simplify(polyline const&, double max_distance);
 
+// Douglas-Peucker with a tolerance in meters: projects the line once into a
+// local equirectangular frame (centimeter grid) around its mean latitude.
+polyline simplify_metric(polyline const&, double max_distance_meters);
+
+namespace detail {
+
+polyline simplify_projected(polyline const&, std::vector<pixel_xy> const&,
+                            uint64_t squared_threshold);
+
+}  // namespace detail
+
+// Douglas-Peucker with a tolerance of one pixel at zoom level z.
 template <int TileSize, int MaxZoomLevel = 20>
 polyline simplify(polyline const& line, uint32_t const z) {
-  assert(z < MaxZoomLevel);
-
-  struct look_up_table {
-    constexpr look_up_table() : values_() {
-      constexpr auto kMinPixel = 1;
-      for (auto i = 0; i <= MaxZoomLevel; ++i) {
-        double shift = (1U << i) * TileSize;
-        double b = shift / 2.0;
-        double pixel_to_deg = 180. / b;
-        double min_deg = kMinPixel * pixel_to_deg;
-        values_[i] = min_deg * min_deg;
-      }
-    }
-    double values_[MaxZoomLevel + 1];
-  };
-  constexpr auto lut = look_up_table{};
+  assert(z <= MaxZoomLevel);
+  using proj = webmercator<TileSize, MaxZoomLevel>;
+
+  std::vector<pixel_xy> projected;
+  projected.reserve(line.size());
+  for (auto const& pos : line) {
+    projected.push_back(proj::merc_to_pixel(latlng_to_merc(pos), MaxZoomLevel));
+  }
 
-  return simplify(line, lut.values[z]);
+  uint64_t const delta = uint64_t{1U} << (MaxZoomLevel - z);
+  return detail::simplify_projected(line, projected, delta * delta);
 }
 
 polyline extract(polyline const&, std::size_t from, std::size_t to);
@@ -1,22 +1,193 @@
 #pragma once
 
+#include <cassert>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "geo/fixed_latlng.h"
 #include "geo/polyline.h"
+#include "geo/simplify_mask.h"
 
 namespace geo {
 
 constexpr int64_t kPolylineMaskBits = 5;
 constexpr int64_t kPolylineCurrMask = 0b11111;
 constexpr int64_t kPolylineRestMask = ~kPolylineCurrMask;
+constexpr auto kPolylineContinueBit = 0x20U;
+constexpr auto kPolylineCharOffset = 63;
+constexpr auto kPolylineMaxChars = (sizeof(int64_t) * 8 + 4) / 5;
+
+namespace detail {
+
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && \
+                          __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+constexpr auto kPolylineSwar = true;
+#else
+constexpr auto kPolylineSwar = false;
+#endif
+
+// SWAR decoding: eight chars at once, one 5 bit group per byte
+constexpr uint64_t kPolylineSwarBits = 0x1F1F1F1F1F1F1F1FULL;
+constexpr uint64_t kPolylineSwarContinue = 0x2020202020202020ULL;
+constexpr uint64_t kPolylineSwarOffset = 0x3F3F3F3F3F3F3F3FULL;
+
+constexpr uint64_t zigzag(int64_t const x) {
+  return (static_cast<uint64_t>(x) << 1) ^
+         static_cast<uint64_t>(x < 0 ? ~int64_t{0} : int64_t{0});
+}
+
+constexpr int64_t unzigzag(uint64_t const x) {
+  return static_cast<int64_t>(x >> 1) ^ -static_cast<int64_t>(x & 1U);
+}
+
+// same result as std::llround for |x| < 2^62 without the libm call
+// (x - trunc(x) is exact in this range)
+inline int64_t round_to_int(double const x) {
+  auto const t = static_cast<int64_t>(x);
+  auto const frac = x - static_cast<double>(t);
+  return t + static_cast<int64_t>(frac >= 0.5) -
+         static_cast<int64_t>(frac <= -0.5);
+}
+
+// lowest 5 bits of each byte -> lowest 40 bits
+inline uint64_t gather_polyline_groups(uint64_t const w) {
+#if defined(__BMI2__)
+  return _pext_u64(w, kPolylineSwarBits);
+#else
+  auto v = uint64_t{0U};
+  for (auto i = 0U; i < 8U; ++i) {
+    v |= ((w >> (8U * i)) & kPolylineCurrMask) << (5U * i);
+  }
+  return v;
+#endif
+}
+
+inline unsigned trailing_zeros(uint64_t const x) {
+  assert(x != 0U);
+#if defined(_MSC_VER)
+  unsigned long idx = 0;
+  _BitScanForward64(&idx, x);
+  return static_cast<unsigned>(idx);
+#else
+  return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned bit_width(uint64_t const x) {
+  if (x == 0U) {
+    return 0U;
+  }
+#if defined(_MSC_VER)
+  unsigned long idx = 0;
+  _BitScanReverse64(&idx, x);
+  return static_cast<unsigned>(idx) + 1U;
+#else
+  return 64U - static_cast<unsigned>(__builtin_clzll(x));
+#endif
+}
+
+}  // namespace detail
+
+// number of characters push_difference(diff) appends
+inline std::size_t polyline_encoded_size(int64_t const diff) {
+  return (detail::bit_width(detail::zigzag(diff) | 1U) + 4U) / 5U;
+}
+
+// number of encoded values (every value ends with a char without continue bit)
+inline std::size_t polyline_value_count(std::string_view const str) {
+  auto count = std::size_t{0U};
+  for (auto const c : str) {
+    count += ((c - kPolylineCharOffset) & kPolylineContinueBit) == 0 ? 1U : 0U;
+  }
+  return count;
+}
+
+namespace detail {
+
+inline char* write_polyline_value(char* out, int64_t const diff) {
+  auto v = zigzag(diff);
+  for (; v >= kPolylineContinueBit; v >>= kPolylineMaskBits) {
+    *out++ = static_cast<char>(
+        ((v & kPolylineCurrMask) | kPolylineContinueBit) +
+        kPolylineCharOffset);
+  }
+  *out++ = static_cast<char>(v + kPolylineCharOffset);
+  return out;
+}
+
+inline int64_t read_polyline_value(char const*& first, char const* last) {
+  if (kPolylineSwar && last - first >= 8) {
+    auto w = uint64_t{0U};
+    std::memcpy(&w, first, sizeof(w));
+    w -= kPolylineSwarOffset;
+    auto const terminators = ~w & kPolylineSwarContinue;
+    if (terminators != 0U) {
+      auto const size = trailing_zeros(terminators) / 8U + 1U;
+      first += size;
+      return unzigzag(gather_polyline_groups(w) &
+                      ((uint64_t{1U} << (5U * size)) - 1U));
+    }
+  }
+
+  auto buf = uint64_t{0U};
+  auto shift = 0U;
+  auto curr = uint64_t{0U};
+  do {
+    curr = static_cast<uint64_t>(*first++ - kPolylineCharOffset);
+    buf |= (curr & kPolylineCurrMask) << shift;
+    shift += kPolylineMaskBits;
+  } while ((curr & kPolylineContinueBit) != 0U && first != last &&
+           shift < sizeof(buf) * 8U);
+  return unzigzag(buf);
+}
+
+}  // namespace detail
 
 // std::pow is sadly not constexpr
 inline constexpr int64_t pow(int64_t const base, int64_t const exp) {
   return exp == 0 ? 1 : base * pow(base, exp - 1);
 }
 
+namespace detail {
+
+// fixed_latlng (precision 7) -> precision, rounds half away from zero
+template <int64_t Precision>
+constexpr int64_t fixed_to_precision(std::int32_t const c) {
+  static_assert(Precision >= 0 && Precision <= 7,
+                "fixed_latlng has precision 7");
+  constexpr auto kDiv = pow(10, 7 - Precision);
+  auto const q = c / kDiv;
+  auto const r = c % kDiv;
+  return q + static_cast<int64_t>(2 * r >= kDiv) -
+         static_cast<int64_t>(2 * r <= -kDiv);
+}
+
+template <int64_t Precision, typename Pos>
+std::pair<int64_t, int64_t> to_polyline_coordinate(Pos const& pos) {
+  if constexpr (std::is_same_v<Pos, fixed_latlng>) {
+    return {fixed_to_precision<Precision>(pos.lat_),
+            fixed_to_precision<Precision>(pos.lng_)};
+  } else {
+    constexpr auto const kPrecision = pow(10, Precision);
+    return {round_to_int(pos.lat() * kPrecision),
+            round_to_int(pos.lng() * kPrecision)};
+  }
+}
+
+}  // namespace detail
+
 template <int64_t Precision = 5>
 struct polyline_encoder {
   static constexpr auto const kPrecision = pow(10, Precision);
@@ -28,9 +199,17 @@ struct polyline_encoder {
   }
 
   void push(geo::latlng const ll) {
-    int64_t const lat = std::llround(ll.lat_ * kPrecision);
-    int64_t const lng = std::llround(ll.lng_ * kPrecision);
+    auto const [lat, lng] = detail::to_polyline_coordinate<Precision>(ll);
+    push_coordinate(lat, lng);
+  }
 
+  void push_fixed(fixed_latlng const ll) {
+    auto const [lat, lng] = detail::to_polyline_coordinate<Precision>(ll);
+    push_coordinate(lat, lng);
+  }
+
+  // lat / lng already scaled by kPrecision
+  void push_coordinate(int64_t const lat, int64_t const lng) {
     push_difference(lat - last_lat_);
     push_difference(lng - last_lng_);
 
@@ -57,27 +236,10 @@ struct polyline_encoder {
     }
   }
 
-  void push_difference(int64_t diff) {
-    auto tmp = static_cast<int64_t>(static_cast<uint64_t>(diff) << 1);
-    if (diff < 0) {
-      tmp = ~tmp;
-    }
-
-    for (auto i = 0ULL; i < sizeof(int64_t) * 8; i += kPolylineMaskBits) {
-      auto curr = tmp & kPolylineCurrMask;
-      auto rest = tmp & kPolylineRestMask;
-
-      if (rest != 0) {
-        curr |= 0x20;
-      }
-
-      buf_.push_back(static_cast<char>(curr + 63));
-      tmp = tmp >> kPolylineMaskBits;
-
-      if (rest == 0) {
-        break;
-      }
-    }
+  void push_difference(int64_t const diff) {
+    char out[kPolylineMaxChars];
+    auto const end = detail::write_polyline_value(out, diff);
+    buf_.append(out, end);
   }
 
   int64_t last_lat_{0};
@@ -102,46 +264,153 @@ auto with_polyline_encoder(int8_t const precision, Fn&& fn) {
   }
 }
 
-template <int64_t Precision = 5>
-std::string encode_polyline(geo::polyline const& polyline) {
+namespace detail {
+
+// encodes all points line[i] with keep(i) == true
+template <int64_t Precision, typename Polyline, typename Keep>
+std::string encode_polyline_if(Polyline const& line, Keep&& keep) {
   polyline_encoder<Precision> enc;
-  for (auto const ll : polyline) {
-    enc.push(ll);
+
+  auto size = std::size_t{0U};
+  auto last_lat = int64_t{0};
+  auto last_lng = int64_t{0};
+  auto i = std::size_t{0U};
+  for (auto const& pos : line) {
+    if (keep(i++)) {
+      auto const [lat, lng] = to_polyline_coordinate<Precision>(pos);
+      size += polyline_encoded_size(lat - last_lat) +
+              polyline_encoded_size(lng - last_lng);
+      last_lat = lat;
+      last_lng = lng;
+    }
+  }
+
+  enc.buf_.resize(size);
+  auto out = enc.buf_.data();
+  i = 0U;
+  for (auto const& pos : line) {
+    if (keep(i++)) {
+      auto const [lat, lng] = to_polyline_coordinate<Precision>(pos);
+      out = write_polyline_value(out, lat - enc.last_lat_);
+      out = write_polyline_value(out, lng - enc.last_lng_);
+      enc.last_lat_ = lat;
+      enc.last_lng_ = lng;
+    }
   }
+  assert(out == enc.buf_.data() + enc.buf_.size());
+
   return std::move(enc.buf_);
 }
 
-template <int64_t Precision = 5>
-geo::polyline decode_polyline(std::string_view const str) {
-  constexpr auto const kPrecision = pow(10, Precision);
+}  // namespace detail
+
+// Polyline: range of latlng or fixed_latlng
+template <int64_t Precision = 5, typename Polyline = geo::polyline>
+std::string encode_polyline(Polyline const& line) {
+  return detail::encode_polyline_if<Precision>(
+      line, [](std::size_t) { return true; });
+}
+
+// encodes only the points set in the mask (see make_simplify_mask)
+template <int64_t Precision = 5, typename Polyline = geo::polyline>
+std::string encode_polyline(Polyline const& line,
+                            std::vector<bool> const& mask) {
+  assert(mask.size() == line.size());
+  return detail::encode_polyline_if<Precision>(
+      line, [&](std::size_t const i) { return mask[i]; });
+}
+
+// encodes only the points set in the serialized mask at zoom level z
+// (see serialize_simplify_mask)
+template <int64_t Precision = 5, typename Polyline = geo::polyline>
+std::string encode_polyline(Polyline const& line,
+                            std::string_view const serialized_mask,
+                            uint32_t const z) {
+  simplify_mask_reader const reader{serialized_mask.data(), z};
+  assert(reader.size_ == line.size());
+  return detail::encode_polyline_if<Precision>(
+      line, [&](std::size_t const i) { return reader.get_bit(i); });
+}
+
+// number of points decode_polyline yields
+inline std::size_t polyline_point_count(std::string_view const str) {
+  return (polyline_value_count(str) + 1U) / 2U;
+}
+
+// Calls fn(lat, lng) with the fixed point coordinates (scaled by 10^Precision)
+// of every point. If fn returns bool, decoding stops when it returns false.
+template <typename Fn>
+void for_each_polyline_coordinate(std::string_view const str, Fn&& fn) {
   int64_t lat{0};
   int64_t lng{0};
 
-  auto const read = [](char const** first, char const* last) {
-    int64_t buf{0};
-    size_t shift = 0;
-    while (*first != last) {
-      int64_t curr = (**first) - 63;
-      buf |= ((curr & kPolylineCurrMask) << shift);
-      ++(*first);
-      shift += kPolylineMaskBits;
-      if ((curr & 0x20) == 0) {
+  char const* first = str.data();
+  char const* last = str.data() + str.size();
+  while (first != last) {
+    lat += detail::read_polyline_value(first, last);
+    lng += first != last ? detail::read_polyline_value(first, last) : 0;
+    if constexpr (std::is_same_v<std::invoke_result_t<Fn, int64_t, int64_t>,
+                                 bool>) {
+      if (!fn(lat, lng)) {
         break;
       }
+    } else {
+      fn(lat, lng);
     }
-    return (buf & 1) ? ~(buf >> 1) : (buf >> 1);
-  };
+  }
+}
 
-  char const* first = str.data();
-  char const* last = str.data() + str.size();
+// Calls fn(latlng) for every point. Stops early if fn returns false.
+template <int64_t Precision = 5, typename Fn>
+void for_each_polyline_point(std::string_view const str, Fn&& fn) {
+  constexpr auto const kPrecision = pow(10, Precision);
+  for_each_polyline_coordinate(
+      str, [&](int64_t const lat, int64_t const lng) {
+        return fn(geo::latlng{static_cast<double>(lat) / kPrecision,
+                              static_cast<double>(lng) / kPrecision});
+      });
+}
 
-  geo::polyline polyline;
-  while (first != last) {
-    lat += read(&first, last);
-    lng += read(&first, last);
-    polyline.emplace_back(geo::latlng{static_cast<double>(lat) / kPrecision,
-                                      static_cast<double>(lng) / kPrecision});
+// Replaces the contents of out (reusing its capacity) with the points with
+// index in [from, to). Supported value types: latlng and fixed_latlng.
+template <int64_t Precision = 5, typename Container>
+void decode_polyline(std::string_view const str, Container& out,
+                     std::size_t const from = 0U,
+                     std::size_t const to =
+                         std::numeric_limits<std::size_t>::max()) {
+  using value_t = typename std::decay_t<Container>::value_type;
+  constexpr auto const kPrecision = pow(10, Precision);
+
+  out.clear();
+  if (from >= to) {
+    return;
   }
+  auto const size = polyline_point_count(str);
+  out.reserve(std::min(to, size) - std::min(from, size));
+
+  auto idx = std::size_t{0U};
+  for_each_polyline_coordinate(
+      str, [&](int64_t const lat, int64_t const lng) {
+        if (idx++ < from) {
+          return true;
+        }
+        if constexpr (std::is_same_v<value_t, fixed_latlng>) {
+          static_assert(Precision <= 7, "fixed_latlng has precision 7");
+          constexpr auto kScale = pow(10, 7 - Precision);
+          out.push_back(fixed_latlng{static_cast<std::int32_t>(lat * kScale),
+                                     static_cast<std::int32_t>(lng * kScale)});
+        } else {
+          out.push_back(value_t{static_cast<double>(lat) / kPrecision,
+                                static_cast<double>(lng) / kPrecision});
+        }
+        return idx < to;
+      });
+}
+
+template <int64_t Precision = 5>
+geo::polyline decode_polyline(std::string_view const str) {
+  geo::polyline polyline;
+  decode_polyline<Precision>(str, polyline);
   return polyline;
 }
 
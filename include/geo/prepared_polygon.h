@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "geo/box.h"
+#include "geo/fixed_geometry.h"
+#include "geo/fixed_latlng.h"
+#include "geo/latlng.h"
+#include "geo/polygon.h"
+
+namespace geo {
+
+// Polygon ring preprocessed for repeated point-in-polygon tests.
+//
+// Coordinates are converted to fixed_latlng once, every test uses the exact
+// integer crossing rule of within(fixed_latlng, ring): no rounding issues,
+// points on edges shared by two polygons belong to at most one of them.
+// Edges are straight lines in lat/lng (geo::within(latlng, simple_polygon):
+// great circle arcs, the results differ only close to long edges).
+//
+// The latitude range of the bounding box is split into equally high bands.
+// Every band lists (copies of) the edges overlapping it, so a test after the
+// bounding box check only looks at the edges of one band: O(1) on average
+// instead of O(n).
+//
+// Worst case: edges spanning many bands (e.g. fan shaped rings). The band
+// count is halved until there are at most kMaxCopiesPerEdge copies per edge
+// on average, so memory stays O(n) and the build O(n log n), but tests on
+// such rings scan more edges per band (up to O(n)).
+struct prepared_polygon {
+  struct edge {
+    fixed_latlng from_, to_;
+  };
+
+  static constexpr auto const kEdgesPerBand = std::size_t{2U};
+  static constexpr auto const kMaxCopiesPerEdge = std::size_t{8U};
+
+  prepared_polygon() = default;
+
+  // any container of latlng / fixed_latlng, any orientation, closing point
+  // optional
+  template <typename Ring>
+  explicit prepared_polygon(Ring const& ring) {
+    std::vector<fixed_latlng> fixed;
+    fixed.reserve(ring.size());
+    for (auto const& pos : ring) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(pos)>,
+                                   fixed_latlng>) {
+        fixed.push_back(pos);
+      } else {
+        fixed.push_back(fixed_latlng::from_latlng(pos));
+      }
+    }
+    init(fixed);
+  }
+
+  bool within(fixed_latlng const& p) const {
+    if (!box_.contains(p)) {
+      return false;
+    }
+    auto const band = static_cast<std::size_t>(
+        (std::int64_t{p.lat_} - box_.min_.lat_) / band_height_);
+    auto inside = false;
+    for (auto i = band_offsets_[band]; i != band_offsets_[band + 1U]; ++i) {
+      inside ^= detail::crosses_ray(p, edges_[i].from_, edges_[i].to_);
+    }
+    return inside;
+  }
+
+  bool within(latlng const& p) const {
+    return within(fixed_latlng::from_latlng(p));
+  }
+
+  // out[i] = within(points[i]), any container of latlng / fixed_latlng
+  template <typename Points>
+  void within(Points const& points, std::vector<bool>& out) const {
+    out.resize(points.size());
+    auto i = std::size_t{0U};
+    for (auto const& p : points) {
+      out[i++] = within(p);
+    }
+  }
+
+  std::size_t band_count() const {
+    return band_offsets_.empty() ? 0U : band_offsets_.size() - 1U;
+  }
+
+  void init(std::vector<fixed_latlng> const& ring);
+
+  fixed_box box_;
+
+  // band i: latitudes [box_.min_.lat_ + i * h, box_.min_.lat_ + (i + 1) * h)
+  // edges [band_offsets_[i], band_offsets_[i + 1])
+  std::int64_t band_height_{1};
+  std::vector<std::size_t> band_offsets_;
+  std::vector<edge> edges_;
+};
+
+// Polygons with holes prepared for point-in-polygon tests (same rules as
+// prepared_polygon). Points outside the cached bounding box of all outer
+// rings are rejected first, then every ring rejects by its own box.
+struct prepared_multi_polygon {
+  struct part {
+    prepared_polygon outer_;
+    std::vector<prepared_polygon> inners_;
+  };
+
+  prepared_multi_polygon() = default;
+  explicit prepared_multi_polygon(polygon const&);
+  explicit prepared_multi_polygon(multi_polygon const&);
+
+  // inside an outer ring and not inside one of its holes
+  bool within(fixed_latlng const& p) const {
+    if (!box_.contains(p)) {
+      return false;
+    }
+    for (auto const& part : parts_) {
+      if (part.outer_.within(p) &&
+          std::none_of(begin(part.inners_), end(part.inners_),
+                       [&](prepared_polygon const& inner) {
+                         return inner.within(p);
+                       })) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool within(latlng const& p) const {
+    return within(fixed_latlng::from_latlng(p));
+  }
+
+  // out[i] = within(points[i]), any container of latlng / fixed_latlng
+  template <typename Points>
+  void within(Points const& points, std::vector<bool>& out) const {
+    out.resize(points.size());
+    auto i = std::size_t{0U};
+    for (auto const& p : points) {
+      out[i++] = within(p);
+    }
+  }
+
+  // empty box if there are no rings
+  box bounding_box() const { return box_.to_box(); }
+
+  void add(polygon const&);
+
+  fixed_box box_;
+  std::vector<part> parts_;
+};
+
+}  // namespace geo
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "geo/latlng.h"
+#include "geo/xyz.h"
+
+namespace geo {
+
+namespace detail {
+
+// squared distance (xyz units) from q to the closest point of the chords
+// p + t * d, t in [0, 1], inv_len_sq = 1 / |d|^2 (0 if degenerate)
+void chord_dist_sq(xyz const& q, double const* x, double const* y,
+                   double const* z, double const* dx, double const* dy,
+                   double const* dz, double const* inv_len_sq, std::size_t n,
+                   double* out);
+
+// closest point to q on the chord p + t * d, mapped onto the sphere
+// (the chord lies in the plane of the great circle, so this is a point of the
+// great circle arc between p and p + d)
+std::pair<xyz, double> project_on_chord(xyz const& q, xyz const& p,
+                                        xyz const& d, double inv_len_sq);
+
+latlng to_latlng(xyz const&);
+
+// squared distance from q to the box (0 if inside, infinity if empty)
+inline double box_dist_sq(xyz const& q, xyz const& min, xyz const& max) {
+  auto const dx = std::max({min.x_ - q.x_, q.x_ - max.x_, 0.0});
+  auto const dy = std::max({min.y_ - q.y_, q.y_ - max.y_, 0.0});
+  auto const dz = std::max({min.z_ - q.z_, q.z_ - max.z_, 0.0});
+  return dx * dx + dy * dy + dz * dz;
+}
+
+}  // namespace detail
+
+struct polyline_projection {
+  double distance_;  // meters
+  latlng best_;
+  std::size_t segment_idx_;
+  double segment_fraction_;  // position on the segment [0, 1]
+  double offset_;  // meters from the start of the polyline
+};
+
+// Polyline preprocessed for repeated point projections (map matching).
+//
+// Segments are stored as 3D chords (xyz, see xyz.h) in SoA layout. A query
+// clamps the projection onto every chord without branches (SIMD if enabled)
+// and maps the closest chord point back onto the sphere (i.e. onto the great
+// circle arc of the segment). Compared to distance_to_polyline, no Web
+// Mercator projection, angle or haversine computation per segment is required.
+//
+// Blocks of kLeafSize consecutive segments form the leaves of an implicit
+// bounding volume hierarchy (axis aligned boxes in xyz, complete binary tree
+// in array layout). Queries descend nearest child first and prune subtrees
+// that cannot contain a closer segment.
+struct prepared_polyline {
+  static constexpr auto const kLeafSize = std::size_t{16U};
+
+  prepared_polyline() = default;
+
+  // any container of latlng / fixed_latlng
+  template <typename Polyline>
+  explicit prepared_polyline(Polyline const& line) {
+    std::vector<xyz> points;
+    points.reserve(line.size());
+    for (auto const& pos : line) {
+      points.emplace_back(static_cast<latlng>(pos));
+    }
+    init(points);
+  }
+
+  // distance_ is infinity for an empty polyline
+  polyline_projection closest(latlng const&) const;
+
+  // only considers segments [segment_idx - window, segment_idx + window],
+  // e.g. around the previous match of a sequential trace
+  polyline_projection closest(latlng const&, std::size_t segment_idx,
+                              std::size_t window) const;
+
+  std::size_t segment_count() const { return x_.size(); }
+  double length() const { return offsets_.empty() ? 0.0 : offsets_.back(); }
+
+  void init(std::vector<xyz> const&);
+
+  // per segment: start point, direction, 1 / |direction|^2 (0 if degenerate)
+  std::vector<double> x_, y_, z_;
+  std::vector<double> dx_, dy_, dz_;
+  std::vector<double> inv_len_sq_;
+
+  // per vertex: meters from the start of the polyline
+  std::vector<double> offsets_;
+
+  // bounding volume hierarchy: node i has the children 2i+1 and 2i+2,
+  // leaf j (node first_leaf_ + j) covers the segments of block j
+  std::size_t first_leaf_{0U};
+  std::vector<xyz> box_min_, box_max_;
+};
+
+}  // namespace geo
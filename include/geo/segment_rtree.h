@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "geo/latlng.h"
+#include "geo/prepared_polyline.h"
+#include "geo/xyz.h"
+
+namespace geo {
+
+struct segment_match {
+  double distance_;  // meters
+  latlng best_;
+  std::uint32_t line_idx_;
+  std::uint32_t segment_idx_;
+  double segment_fraction_;  // position on the segment [0, 1]
+  double offset_;  // meters from the start of the line
+};
+
+// Static spatial index over the segments of many polylines (e.g. streets).
+//
+// Segments are stored as 3D chords (see prepared_polyline), sorted along a
+// Morton curve of their midpoints and packed into leaves of kLeafSize
+// segments. Inner nodes form an implicit complete binary tree of xyz boxes.
+struct segment_rtree {
+  static constexpr auto const kLeafSize = std::size_t{16U};
+
+  // Reusable buffers: queries with a warmed up state do not allocate.
+  struct query_state {
+    std::vector<std::pair<double, std::size_t>> nodes_;  // min heap
+    std::vector<std::pair<double, std::size_t>> candidates_;  // max heap
+    std::vector<segment_match> results_;  // sorted by distance
+  };
+
+  segment_rtree() = default;
+
+  // any container of polylines (e.g. std::vector<polyline>, cista nvec)
+  // with latlng / fixed_latlng coordinates
+  template <typename Polylines>
+  explicit segment_rtree(Polylines const& lines) {
+    std::vector<xyz> points;
+    std::vector<std::size_t> line_offsets;
+    line_offsets.reserve(lines.size() + 1U);
+    for (auto const& line : lines) {
+      line_offsets.push_back(points.size());
+      for (auto const& pos : line) {
+        points.emplace_back(static_cast<latlng>(pos));
+      }
+    }
+    line_offsets.push_back(points.size());
+    init(points, line_offsets);
+  }
+
+  // k nearest segments, results in state.results_
+  void nearest(latlng const&, unsigned k, query_state&) const;
+
+  std::vector<segment_match> nearest(latlng const&, unsigned k) const;
+
+  std::size_t size() const { return x_.size(); }
+
+  void init(std::vector<xyz> const& points,
+            std::vector<std::size_t> const& line_offsets);
+
+  // per segment (in tree order)
+  std::vector<double> x_, y_, z_;
+  std::vector<double> dx_, dy_, dz_;
+  std::vector<double> inv_len_sq_;
+  std::vector<double> offsets_;
+  std::vector<std::uint32_t> line_idx_, segment_idx_;
+
+  // node i has the children 2i+1 and 2i+2, leaf j = node first_leaf_ + j
+  std::size_t first_leaf_{0U};
+  std::vector<xyz> box_min_, box_max_;
+};
+
+}  // namespace geo
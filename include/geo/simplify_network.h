@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geo/polyline.h"
+#include "geo/simplify_mask.h"
+
+namespace geo {
+
+// Topology preserving simplification of a set of polylines.
+//
+// Vertices are identified by their pixel position at kMaxSimplifyZoomLevel.
+// Every polyline is split at its endpoints and at junctions (vertices with
+// more or less than two distinct neighbours across all lines). The resulting
+// runs are deduplicated (independent of their direction) and simplified once.
+// Lines sharing a run (e.g. several transit lines on the same street) thus
+// get identical masks for the shared part.
+//
+// Returns one mask per input line (same format as make_simplify_mask).
+std::vector<simplify_mask_t> make_network_simplify_masks(
+    std::vector<polyline> const& lines, uint32_t pixel_precision = 1);
+
+}  // namespace geo
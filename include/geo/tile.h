@@ -1,5 +1,13 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 #include "geo/webmercator.h"
 
 namespace geo {
@@ -38,6 +46,125 @@ struct tile {
   uint32_t x_, y_, z_;
 };
 
+/* +------------------------------------------------------------------------+ */
+/* | Morton code / packed tile id                                           | */
+/* +------------------------------------------------------------------------+ */
+
+namespace detail {
+
+// bit i -> bit 2i
+inline std::uint64_t morton_spread(std::uint32_t const v) {
+#if defined(__BMI2__)
+  return _pdep_u64(v, 0x5555555555555555ULL);
+#else
+  auto x = static_cast<std::uint64_t>(v);
+  x = (x | x << 16U) & 0x0000FFFF0000FFFFULL;
+  x = (x | x << 8U) & 0x00FF00FF00FF00FFULL;
+  x = (x | x << 4U) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | x << 2U) & 0x3333333333333333ULL;
+  x = (x | x << 1U) & 0x5555555555555555ULL;
+  return x;
+#endif
+}
+
+// bit 2i -> bit i
+inline std::uint32_t morton_compact(std::uint64_t const v) {
+#if defined(__BMI2__)
+  return static_cast<std::uint32_t>(_pext_u64(v, 0x5555555555555555ULL));
+#else
+  auto x = v & 0x5555555555555555ULL;
+  x = (x | x >> 1U) & 0x3333333333333333ULL;
+  x = (x | x >> 2U) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | x >> 4U) & 0x00FF00FF00FF00FFULL;
+  x = (x | x >> 8U) & 0x0000FFFF0000FFFFULL;
+  x = (x | x >> 16U) & 0x00000000FFFFFFFFULL;
+  return static_cast<std::uint32_t>(x);
+#endif
+}
+
+}  // namespace detail
+
+// x in the even bits, y in the odd bits (the lowest two bits are quad_pos)
+inline std::uint64_t morton_encode(std::uint32_t const x,
+                                   std::uint32_t const y) {
+  return detail::morton_spread(x) | detail::morton_spread(y) << 1U;
+}
+
+inline std::pair<std::uint32_t, std::uint32_t> morton_decode(
+    std::uint64_t const code) {
+  return {detail::morton_compact(code), detail::morton_compact(code >> 1U)};
+}
+
+// Tile packed into 64 bits: z in the highest bits, the Morton code (quadkey)
+// of x and y in the lowest 2z bits. Ordered by z, then along the Z-order
+// curve: all descendants of a tile on one level form a contiguous id range.
+struct tile_id {
+  static constexpr auto const kZShift = 58U;
+  static constexpr auto const kMaxZ = 29U;
+  static constexpr auto const kMortonMask =
+      (std::uint64_t{1U} << kZShift) - 1U;
+
+  tile_id() = default;
+  explicit tile_id(std::uint64_t const id) : id_{id} {}
+  explicit tile_id(tile const& t)
+      : tile_id{morton_encode(t.x_, t.y_), t.z_} {}
+  tile_id(std::uint64_t const morton, std::uint32_t const z)
+      : id_{static_cast<std::uint64_t>(z) << kZShift | morton} {
+    assert(z <= kMaxZ);
+  }
+
+  std::uint32_t z() const {
+    return static_cast<std::uint32_t>(id_ >> kZShift);
+  }
+  std::uint64_t morton() const { return id_ & kMortonMask; }
+
+  tile as_tile() const {
+    auto const [x, y] = morton_decode(morton());
+    return {x, y, z()};
+  }
+
+  // numbering of the (four) tiles sharing a parent, see tile::quad_pos
+  std::uint32_t quad_pos() const {
+    return static_cast<std::uint32_t>(id_ & 3U);
+  }
+
+  [[nodiscard]] tile_id parent() const { return ancestor(z() - 1U); }
+
+  [[nodiscard]] tile_id child(std::uint32_t const quad_pos) const {
+    return {morton() << 2U | quad_pos, z() + 1U};
+  }
+
+  [[nodiscard]] tile_id ancestor(std::uint32_t const z) const {
+    assert(z <= this->z());
+    return {morton() >> (2U * (this->z() - z)), z};
+  }
+
+  // [first, last] descendant on level z >= z()
+  [[nodiscard]] tile_id first_descendant(std::uint32_t const z) const {
+    assert(z >= this->z());
+    return {morton() << (2U * (z - this->z())), z};
+  }
+
+  [[nodiscard]] tile_id last_descendant(std::uint32_t const z) const {
+    assert(z >= this->z());
+    return {((morton() + 1U) << (2U * (z - this->z()))) - 1U, z};
+  }
+
+  bool contains(tile_id const o) const {
+    return o.z() >= z() && o.ancestor(z()) == *this;
+  }
+
+  bool operator<(tile_id const& o) const { return id_ < o.id_; }
+  bool operator==(tile_id const& o) const { return id_ == o.id_; }
+  bool operator!=(tile_id const& o) const { return id_ != o.id_; }
+
+  friend std::ostream& operator<<(std::ostream& o, tile_id const& t) {
+    return o << t.as_tile();
+  }
+
+  std::uint64_t id_;
+};
+
 inline tile_iterator_bounds make_no_bounds(uint32_t z) {
   return tile_iterator_bounds{0, 0, 1U << z, 1U << z};
 }
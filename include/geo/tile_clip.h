@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geo/polygon.h"
+#include "geo/polyline.h"
+#include "geo/tile.h"
+#include "geo/webmercator.h"
+#include "geo/webmercator_batch.h"
+
+namespace geo {
+
+// Clipping in integer pixel coordinates, bounds are inclusive.
+// Intersections are rounded to the nearest pixel.
+
+// Cohen-Sutherland per segment, returns the parts inside the bounds
+std::vector<std::vector<pixel_xy>> clip_line(std::vector<pixel_xy> const&,
+                                             pixel_bounds const&);
+
+// Sutherland-Hodgman, ring without closing point (empty if outside)
+std::vector<pixel_xy> clip_ring(std::vector<pixel_xy> const&,
+                                pixel_bounds const&);
+
+struct tile_geometry {
+  tile tile_;
+
+  // tile-local pixel coordinates in [-buffer, tile_size + buffer]
+  // lines: parts, polygons: one ring
+  std::vector<std::vector<pixel_xy>> parts_;
+};
+
+namespace detail {
+
+// Recursively halves the covered tile range and clips the geometry to each
+// half, so every tile receives only the geometry of its parent range:
+// O(n log tiles) instead of O(n * tiles) for clipping every tile separately.
+std::vector<tile_geometry> clip_to_tiles(std::vector<pixel_xy> const&,
+                                         bool is_polygon, std::uint32_t z,
+                                         pixel_coord_t tile_size,
+                                         pixel_coord_t buffer);
+
+}  // namespace detail
+
+// Projects the feature once and emits the clipped geometry of every tile on
+// level z it intersects (including the buffer), sorted by tile.
+template <typename Proj = default_webmercator>
+std::vector<tile_geometry> clip_line_to_tiles(polyline const& line,
+                                              std::uint32_t const z,
+                                              pixel_coord_t const buffer) {
+  std::vector<pixel_xy> px;
+  latlng_to_pixel<Proj>(line, z, px);
+  return detail::clip_to_tiles(px, false, z, Proj::kTileSize, buffer);
+}
+
+template <typename Proj = default_webmercator>
+std::vector<tile_geometry> clip_polygon_to_tiles(simple_polygon const& ring,
+                                                 std::uint32_t const z,
+                                                 pixel_coord_t const buffer) {
+  std::vector<pixel_xy> px;
+  latlng_to_pixel<Proj>(ring, z, px);
+  return detail::clip_to_tiles(px, true, z, Proj::kTileSize, buffer);
+}
+
+}  // namespace geo
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geo/box.h"
+#include "geo/polygon.h"
+#include "geo/polyline.h"
+#include "geo/tile.h"
+
+// Tiles intersected by a geometry (e.g. to generate only the vector tiles a
+// route or a coastline touches).
+//
+// Edges are straight lines in Web Mercator (like rendered). Lines are
+// rasterized with a grid traversal (DDA), polygons with their boundary plus
+// a scanline fill over tile centers. Results are sorted by tile_id and
+// unique. z <= tile_id::kMaxZ.
+
+namespace geo {
+
+// tile on level z containing the position
+tile_id tile_at(latlng const&, std::uint32_t z);
+
+std::vector<tile_id> tile_cover_line(polyline const&, std::uint32_t z);
+
+// ring, closing edge (last -> first) is implicit
+std::vector<tile_id> tile_cover_polygon(simple_polygon const&,
+                                        std::uint32_t z);
+
+std::vector<tile_id> tile_cover_box(box const&, std::uint32_t z);
+
+// Replaces all complete sets of four siblings by their parent (recursively,
+// not above min_z). Input: sorted unique tiles of one level.
+std::vector<tile_id> compact_tile_cover(std::vector<tile_id> const& cover,
+                                        std::uint32_t min_z = 0U);
+
+}  // namespace geo
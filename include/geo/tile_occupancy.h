@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "geo/latlng.h"
+#include "geo/polyline.h"
+#include "geo/tile.h"
+
+namespace geo {
+
+// Non-empty tiles of a pyramid [0, max_z] with the number of distinct
+// features per tile. Per level: sorted (tile_id, count) list, so the
+// occupied descendants of a tile on a level are a contiguous slice.
+// Memory and build time are proportional to the (tile, feature) pairs on
+// max_z, not to the size of the pyramid.
+struct tile_occupancy {
+  struct entry {
+    bool operator<(entry const& o) const { return tile_ < o.tile_; }
+
+    tile_id tile_;
+    std::uint32_t count_;
+  };
+
+  tile_occupancy() = default;
+
+  // (tile on max_z, feature index) pairs, any order, duplicates allowed
+  tile_occupancy(std::vector<std::pair<tile_id, std::uint32_t>> tile_features,
+                 std::uint32_t max_z);
+
+  // number of distinct features intersecting the tile (0 if empty)
+  std::uint32_t count(tile_id) const;
+
+  std::vector<entry> const& occupied(std::uint32_t const z) const {
+    return levels_.at(z);
+  }
+
+  // fn(entry const&) for the occupied descendants of t on level z >= t.z()
+  template <typename Fn>
+  void for_each_occupied(tile_id const t, std::uint32_t const z,
+                         Fn&& fn) const {
+    auto const& level = levels_.at(z);
+    auto it = std::lower_bound(begin(level), end(level),
+                               entry{t.first_descendant(z), 0U});
+    auto const last = t.last_descendant(z);
+    for (; it != end(level) && !(last < it->tile_); ++it) {
+      fn(*it);
+    }
+  }
+
+  std::uint32_t max_z_{0U};
+  std::vector<std::vector<entry>> levels_;  // index: z
+};
+
+tile_occupancy make_tile_occupancy(std::vector<latlng> const& points,
+                                   std::uint32_t max_z);
+
+tile_occupancy make_tile_occupancy(std::vector<polyline> const& lines,
+                                   std::uint32_t max_z);
+
+}  // namespace geo
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "utl/parallel_for.h"
+
+#include "geo/tile.h"
+
+namespace geo {
+
+// Tiles below a rectangle of tiles on level min_z, down to max_z.
+// Linear tile index: z-major, then row-major (order of tile_iterator).
+struct tile_pyramid {
+  tile_pyramid() = default;
+
+  // bounds on level min_z, [min, max)
+  tile_pyramid(tile_iterator_bounds const& bounds, std::uint32_t const min_z,
+               std::uint32_t const max_z)
+      : bounds_{bounds}, min_z_{min_z}, max_z_{max_z} {}
+
+  // all tiles of the levels [0, max_z]
+  static tile_pyramid full(std::uint32_t max_z);
+
+  // t and its descendants down to max_z
+  static tile_pyramid subtree(tile const& t, std::uint32_t max_z);
+
+  std::uint64_t size() const;
+  std::uint64_t level_size(std::uint32_t z) const;
+  tile_iterator_bounds bounds_on_z(std::uint32_t z) const;
+
+  // i < size()
+  tile at(std::uint64_t i) const;
+
+  tile_iterator_bounds bounds_;
+  std::uint32_t min_z_{0U}, max_z_{0U};
+};
+
+// Contiguous slice [from, to) of the linear tile indices of a pyramid:
+// random access, balanced split, sequential iteration.
+// Distributing over processes: split(n_processes)[process_idx].
+struct tile_partition {
+  tile_partition() = default;
+
+  explicit tile_partition(tile_pyramid const& pyramid)
+      : pyramid_{pyramid}, from_{0U}, to_{pyramid.size()} {}
+
+  tile_partition(tile_pyramid const& pyramid, std::uint64_t const from,
+                 std::uint64_t const to)
+      : pyramid_{pyramid}, from_{from}, to_{to} {}
+
+  std::uint64_t size() const { return to_ - from_; }
+  bool empty() const { return from_ == to_; }
+
+  tile operator[](std::uint64_t const i) const {
+    return pyramid_.at(from_ + i);
+  }
+
+  // n parts, sizes differ by at most one tile
+  std::vector<tile_partition> split(std::size_t n) const;
+
+  // fn(tile const&) in index order
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    if (empty()) {
+      return;
+    }
+
+    auto t = pyramid_.at(from_);
+    auto bounds = pyramid_.bounds_on_z(t.z_);
+    for (auto i = from_; i < to_; ++i) {
+      fn(std::as_const(t));
+
+      ++t.x_;
+      if (t.x_ == bounds.maxx_) {
+        t.x_ = bounds.minx_;
+        ++t.y_;
+        if (t.y_ == bounds.maxy_) {
+          ++t.z_;
+          bounds = pyramid_.bounds_on_z(t.z_);
+          t.x_ = bounds.minx_;
+          t.y_ = bounds.miny_;
+        }
+      }
+    }
+  }
+
+  tile_pyramid pyramid_;
+  std::uint64_t from_{0U}, to_{0U};
+};
+
+// fn(tile const&) for every tile of the partition, chunks of chunk_size tiles
+// are distributed over utl::parallel_for_run (no order guarantee)
+template <typename Fn>
+void parallel_for_each_tile(tile_partition const& partition, Fn&& fn,
+                            std::uint64_t const chunk_size = 1024U) {
+  auto const chunks =
+      partition.split((partition.size() + chunk_size - 1U) / chunk_size);
+  utl::parallel_for_run(chunks.size(), [&](std::size_t const i) {
+    chunks[i].for_each(fn);
+  });
+}
+
+}  // namespace geo
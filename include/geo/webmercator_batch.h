@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "utl/parallel_for.h"
+
+#include "geo/detail/fast_math.h"
+#include "geo/latlng.h"
+#include "geo/webmercator.h"
+
+// Bulk latlng <-> merc <-> pixel conversion (e.g. tile rendering, map
+// matching preprocessing).
+//
+// Builds with AVX2 or AVX-512 enabled at compile time (e.g. -march=native,
+// -mavx2) replace std::sin / std::log / std::exp / std::atan in the per
+// element transforms with the branch free polynomials from
+// detail/fast_math.h, so the inner loops are vectorized by the compiler.
+// Without these targets, the polynomials are slower than the std:: functions
+// (scalar code), all other builds use the functions from webmercator.h and
+// only gain from batching / parallelism. Deviation of the fast path from the
+// scalar functions in webmercator.h:
+//   - latlng -> merc: x identical, |dy| < 1e-6 meters
+//   - merc -> latlng: |dlat|, |dlng| < 1e-12 degrees
+//   - pixel: identical except for rounding ties (+/- 1 pixel)
+//
+// Input: any random access container of latlng / fixed_latlng (or merc_xy /
+// pixel_xy), output vectors are resized. With parallel = true, chunks of
+// kBatchChunkSize elements are distributed over utl::parallel_for_run.
+
+namespace geo {
+
+namespace detail {
+
+constexpr auto const kBatchChunkSize = std::size_t{8192U};
+
+// runs fn(from, to) for chunks of [0, n)
+template <typename Fn>
+void for_each_batch_chunk(std::size_t const n, bool const parallel, Fn&& fn) {
+  if (!parallel || n <= kBatchChunkSize) {
+    fn(std::size_t{0U}, n);
+    return;
+  }
+  utl::parallel_for_run((n + kBatchChunkSize - 1U) / kBatchChunkSize,
+                        [&](std::size_t const chunk) {
+                          auto const from = chunk * kBatchChunkSize;
+                          fn(from, std::min(from + kBatchChunkSize, n));
+                        });
+}
+
+}  // namespace detail
+
+inline merc_xy fast_latlng_to_merc(latlng const& pos) {
+  auto const lat =
+      detail::branch_free_clamp(pos.lat_, -kMercMaxLatitude, kMercMaxLatitude);
+  auto const sin = detail::fast_sin(to_rad(lat));
+  return {kMercEarthRadius * to_rad(pos.lng_),
+          kMercEarthRadius * detail::fast_log((1. + sin) / (1. - sin)) / 2.};
+}
+
+// 2 * atan(e^t) - pi / 2 = 2 * atan((e^t - 1) / (e^t + 1))
+inline latlng fast_merc_to_latlng(merc_xy const& xy) {
+  constexpr auto d = 180. / kPI;
+  auto const e = detail::fast_exp(xy.y_ / kMercEarthRadius);
+  return {2.0 * detail::fast_atan((e - 1.0) / (e + 1.0)) * d,
+          xy.x_ * d / kMercEarthRadius};
+}
+
+namespace detail {
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+constexpr auto const kFastBatchMath = true;
+#else
+constexpr auto const kFastBatchMath = false;
+#endif
+
+inline merc_xy batch_latlng_to_merc(latlng const& pos) {
+  if constexpr (kFastBatchMath) {
+    return fast_latlng_to_merc(pos);
+  } else {
+    return geo::latlng_to_merc(pos);
+  }
+}
+
+inline latlng batch_merc_to_latlng(merc_xy const& xy) {
+  if constexpr (kFastBatchMath) {
+    return fast_merc_to_latlng(xy);
+  } else {
+    return geo::merc_to_latlng(xy);
+  }
+}
+
+}  // namespace detail
+
+template <typename Coords>
+void latlng_to_merc(Coords const& in, std::vector<merc_xy>& out,
+                    bool const parallel = false) {
+  out.resize(in.size());
+  detail::for_each_batch_chunk(
+      in.size(), parallel, [&](std::size_t const from, std::size_t const to) {
+        for (auto i = from; i < to; ++i) {
+          out[i] = detail::batch_latlng_to_merc(static_cast<latlng>(in[i]));
+        }
+      });
+}
+
+template <typename MercCoords>
+void merc_to_latlng(MercCoords const& in, std::vector<latlng>& out,
+                    bool const parallel = false) {
+  out.resize(in.size());
+  detail::for_each_batch_chunk(
+      in.size(), parallel, [&](std::size_t const from, std::size_t const to) {
+        for (auto i = from; i < to; ++i) {
+          out[i] = detail::batch_merc_to_latlng(in[i]);
+        }
+      });
+}
+
+template <typename Proj, typename Coords>
+void latlng_to_pixel(Coords const& in, std::uint32_t const z,
+                     std::vector<pixel_xy>& out, bool const parallel = false) {
+  out.resize(in.size());
+  detail::for_each_batch_chunk(
+      in.size(), parallel, [&](std::size_t const from, std::size_t const to) {
+        for (auto i = from; i < to; ++i) {
+          out[i] = Proj::merc_to_pixel(
+              detail::batch_latlng_to_merc(static_cast<latlng>(in[i])), z);
+        }
+      });
+}
+
+template <typename Proj, typename PixelCoords>
+void pixel_to_latlng(PixelCoords const& in, std::uint32_t const z,
+                     std::vector<latlng>& out, bool const parallel = false) {
+  out.resize(in.size());
+  detail::for_each_batch_chunk(
+      in.size(), parallel, [&](std::size_t const from, std::size_t const to) {
+        for (auto i = from; i < to; ++i) {
+          out[i] = detail::batch_merc_to_latlng(Proj::pixel_to_merc(in[i], z));
+        }
+      });
+}
+
+}  // namespace geo
@@ -0,0 +1,203 @@
+#include "geo/distance_batch.h"
+
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "geo/constants.h"
+
+namespace geo {
+
+namespace {
+
+void chord_squared(xyz const& a, double const* x, double const* y,
+                   double const* z, std::size_t const n, double* out) {
+  auto i = std::size_t{0U};
+
+#if defined(__AVX512F__)
+  {
+    auto const ax = _mm512_set1_pd(a.x_);
+    auto const ay = _mm512_set1_pd(a.y_);
+    auto const az = _mm512_set1_pd(a.z_);
+    for (; i + 8U <= n; i += 8U) {
+      auto const dx = _mm512_sub_pd(ax, _mm512_loadu_pd(x + i));
+      auto const dy = _mm512_sub_pd(ay, _mm512_loadu_pd(y + i));
+      auto const dz = _mm512_sub_pd(az, _mm512_loadu_pd(z + i));
+      _mm512_storeu_pd(
+          out + i,
+          _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx),
+                                      _mm512_mul_pd(dy, dy)),
+                        _mm512_mul_pd(dz, dz)));
+    }
+  }
+#endif
+
+#if defined(__AVX2__)
+  {
+    auto const ax = _mm256_set1_pd(a.x_);
+    auto const ay = _mm256_set1_pd(a.y_);
+    auto const az = _mm256_set1_pd(a.z_);
+    for (; i + 4U <= n; i += 4U) {
+      auto const dx = _mm256_sub_pd(ax, _mm256_loadu_pd(x + i));
+      auto const dy = _mm256_sub_pd(ay, _mm256_loadu_pd(y + i));
+      auto const dz = _mm256_sub_pd(az, _mm256_loadu_pd(z + i));
+      _mm256_storeu_pd(
+          out + i,
+          _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx),
+                                      _mm256_mul_pd(dy, dy)),
+                        _mm256_mul_pd(dz, dz)));
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    auto const dx = a.x_ - x[i];
+    auto const dy = a.y_ - y[i];
+    auto const dz = a.z_ - z[i];
+    out[i] = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+double chord_squared_to_haversine(double const d) {
+  return 2.0 * kEarthRadiusMeters * std::asin(std::min(std::sqrt(d), 1.0));
+}
+
+void chord_squared_to_haversine(double* out, std::size_t const n) {
+  for (auto i = std::size_t{0U}; i < n; ++i) {
+    out[i] = chord_squared_to_haversine(out[i]);
+  }
+}
+
+// same formula as distance<distance_type::kEquirectangular>: longitude
+// scaled at the mean latitude of both points. The cosine (scalar, one per
+// element) is stored in out first and read back by the vectorized loops.
+void equirectangular(latlng const& a, double const* lat, double const* lng,
+                     std::size_t const n, double* out) {
+  constexpr auto const kToRad = kPI / 180.0;
+  auto const scale = kToRad * kEarthRadiusMeters;
+
+  for (auto i = std::size_t{0U}; i < n; ++i) {
+    out[i] = std::cos((a.lat_ + lat[i]) * kToRad / 2.0);
+  }
+
+  auto i = std::size_t{0U};
+
+#if defined(__AVX512F__)
+  {
+    auto const a_lat = _mm512_set1_pd(a.lat_);
+    auto const a_lng = _mm512_set1_pd(a.lng_);
+    auto const s = _mm512_set1_pd(scale);
+    auto const full = _mm512_set1_pd(360.0);
+    for (; i + 8U <= n; i += 8U) {
+      auto const y =
+          _mm512_mul_pd(_mm512_sub_pd(a_lat, _mm512_loadu_pd(lat + i)), s);
+      auto const d_lng =
+          _mm512_abs_pd(_mm512_sub_pd(a_lng, _mm512_loadu_pd(lng + i)));
+      auto const x = _mm512_mul_pd(
+          _mm512_mul_pd(_mm512_min_pd(d_lng, _mm512_sub_pd(full, d_lng)), s),
+          _mm512_loadu_pd(out + i));
+      _mm512_storeu_pd(out + i, _mm512_sqrt_pd(_mm512_add_pd(
+                                    _mm512_mul_pd(x, x), _mm512_mul_pd(y, y))));
+    }
+  }
+#endif
+
+#if defined(__AVX2__)
+  {
+    auto const a_lat = _mm256_set1_pd(a.lat_);
+    auto const a_lng = _mm256_set1_pd(a.lng_);
+    auto const s = _mm256_set1_pd(scale);
+    auto const full = _mm256_set1_pd(360.0);
+    auto const sign = _mm256_set1_pd(-0.0);
+    for (; i + 4U <= n; i += 4U) {
+      auto const y =
+          _mm256_mul_pd(_mm256_sub_pd(a_lat, _mm256_loadu_pd(lat + i)), s);
+      auto const d_lng = _mm256_andnot_pd(
+          sign, _mm256_sub_pd(a_lng, _mm256_loadu_pd(lng + i)));
+      auto const x = _mm256_mul_pd(
+          _mm256_mul_pd(_mm256_min_pd(d_lng, _mm256_sub_pd(full, d_lng)), s),
+          _mm256_loadu_pd(out + i));
+      _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_add_pd(
+                                    _mm256_mul_pd(x, x), _mm256_mul_pd(y, y))));
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    auto const y = (a.lat_ - lat[i]) * scale;
+    auto const d_lng = std::abs(a.lng_ - lng[i]);
+    auto const x = std::min(d_lng, 360.0 - d_lng) * scale * out[i];
+    out[i] = std::sqrt(x * x + y * y);
+  }
+}
+
+}  // namespace
+
+void chord_squared_distances(xyz const& a, xyz_soa const& b,
+                             std::vector<double>& out) {
+  out.resize(b.size());
+  chord_squared(a, b.x_.data(), b.y_.data(), b.z_.data(), b.size(),
+                out.data());
+}
+
+void haversine_distances(xyz const& a, xyz_soa const& b,
+                         std::vector<double>& out) {
+  chord_squared_distances(a, b, out);
+  chord_squared_to_haversine(out.data(), out.size());
+}
+
+void haversine_distances(xyz_soa const& a, xyz_soa const& b,
+                         std::vector<double>& out) {
+  out.resize(a.size() * b.size());
+  for (auto i = std::size_t{0U}; i < a.size(); ++i) {
+    chord_squared(a[i], b.x_.data(), b.y_.data(), b.z_.data(), b.size(),
+                  out.data() + i * b.size());
+  }
+  chord_squared_to_haversine(out.data(), out.size());
+}
+
+std::pair<double, std::size_t> nearest(xyz const& a, xyz_soa const& b) {
+  constexpr auto const kBlockSize = std::size_t{256U};
+
+  auto buf = std::array<double, kBlockSize>{};
+  auto best = std::numeric_limits<double>::infinity();
+  auto best_idx = std::size_t{0U};
+  for (auto from = std::size_t{0U}; from < b.size(); from += kBlockSize) {
+    auto const n = std::min(kBlockSize, b.size() - from);
+    chord_squared(a, b.x_.data() + from, b.y_.data() + from,
+                  b.z_.data() + from, n, buf.data());
+    for (auto i = std::size_t{0U}; i < n; ++i) {
+      if (buf[i] < best) {
+        best = buf[i];
+        best_idx = from + i;
+      }
+    }
+  }
+
+  if (b.size() == 0U) {
+    return {best, best_idx};
+  }
+  return {chord_squared_to_haversine(best), best_idx};
+}
+
+void equirectangular_distances(latlng const& a, latlng_soa const& b,
+                               std::vector<double>& out) {
+  out.resize(b.size());
+  equirectangular(a, b.lat_.data(), b.lng_.data(), b.size(), out.data());
+}
+
+void equirectangular_distances(latlng_soa const& a, latlng_soa const& b,
+                               std::vector<double>& out) {
+  out.resize(a.size() * b.size());
+  for (auto i = std::size_t{0U}; i < a.size(); ++i) {
+    equirectangular(a[i], b.lat_.data(), b.lng_.data(), b.size(),
+                    out.data() + i * b.size());
+  }
+}
+
+}  // namespace geo
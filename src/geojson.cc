@@ -0,0 +1,209 @@
+#include "geo/geojson.h"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "geo/detail/text_input.h"
+
+namespace geo {
+
+namespace {
+
+constexpr auto const kMaxDepth = 256U;
+
+struct geojson_scanner {
+  [[noreturn]] void fail(char const* msg) const {
+    throw std::runtime_error{std::string{"geojson: "} + msg + " at offset " +
+                             std::to_string(pos_ - begin_)};
+  }
+
+  char peek() {
+    detail::skip_spaces(pos_, end_);
+    if (pos_ == end_) {
+      fail("unexpected end");
+    }
+    return *pos_;
+  }
+
+  bool consume(char const c) {
+    if (peek() != c) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  void expect(char const c) {
+    if (!consume(c)) {
+      fail("unexpected character");
+    }
+  }
+
+  // calls fn() for every element of an array / member of an object
+  template <typename Fn>
+  void list(char const open, char const close, Fn&& fn) {
+    expect(open);
+    if (consume(close)) {
+      return;
+    }
+    do {
+      fn();
+    } while (consume(','));
+    expect(close);
+  }
+
+  // raw contents, escape sequences are not resolved
+  std::string_view string() {
+    expect('"');
+    auto const begin = pos_;
+    while (pos_ != end_ && *pos_ != '"') {
+      pos_ += (*pos_ == '\\' && pos_ + 1 != end_) ? 2 : 1;
+    }
+    if (pos_ == end_) {
+      fail("unterminated string");
+    }
+    return {begin, static_cast<std::size_t>(pos_++ - begin)};
+  }
+
+  // true, false, null or a number
+  void literal() {
+    for (auto const lit : {std::string_view{"true"}, std::string_view{"false"},
+                           std::string_view{"null"}}) {
+      if (std::string_view{pos_, static_cast<std::size_t>(end_ - pos_)}
+              .substr(0U, lit.size()) == lit) {
+        pos_ += lit.size();
+        return;
+      }
+    }
+    number();
+  }
+
+  // JSON numbers start with a digit or '-' and a digit (no inf / nan)
+  double number() {
+    peek();
+    auto const digit = *pos_ == '-' ? pos_ + 1 : pos_;
+    if (digit == end_ || *digit < '0' || *digit > '9') {
+      fail("invalid number");
+    }
+    return detail::parse_double(pos_, end_);
+  }
+
+  // [lng, lat, (altitude)]
+  latlng position() {
+    auto pos = latlng{};
+    auto i = 0U;
+    list('[', ']', [&]() {
+      auto const x = number();
+      if (i == 0U) {
+        pos.lng_ = x;
+      } else if (i == 1U) {
+        pos.lat_ = x;
+      }
+      ++i;
+    });
+    if (i < 2U) {
+      fail("position with less than two coordinates");
+    }
+    return pos;
+  }
+
+  simple_polygon ring() {
+    simple_polygon r;
+    list('[', ']', [&]() { r.push_back(position()); });
+    return r;
+  }
+
+  void polygon_coordinates() {
+    auto p = polygon{};
+    auto first = true;
+    list('[', ']', [&]() {
+      if (first) {
+        p.outer_ = ring();
+        first = false;
+      } else {
+        p.inners_.emplace_back(ring());
+      }
+    });
+    if (!p.outer_.empty()) {
+      out_.emplace_back(std::move(p));
+    }
+  }
+
+  void coordinates(std::string_view const type) {
+    if (type == "Polygon") {
+      polygon_coordinates();
+    } else {
+      list('[', ']', [&]() { polygon_coordinates(); });
+    }
+  }
+
+  static bool is_polygon_type(std::string_view const type) {
+    return type == "Polygon" || type == "MultiPolygon";
+  }
+
+  void object(unsigned const depth) {
+    auto type = std::string_view{};
+    char const* deferred_coordinates = nullptr;
+    list('{', '}', [&]() {
+      auto const key = string();
+      expect(':');
+      if (key == "type" && peek() == '"') {
+        type = string();
+      } else if (key == "coordinates" && is_polygon_type(type)) {
+        coordinates(type);
+      } else if (key == "coordinates" && type.empty()) {
+        // "type" may follow
+        deferred_coordinates = pos_;
+        value(depth + 1U);
+      } else {
+        value(depth + 1U);
+      }
+    });
+
+    if (deferred_coordinates != nullptr && is_polygon_type(type)) {
+      auto const end = pos_;
+      pos_ = deferred_coordinates;
+      coordinates(type);
+      pos_ = end;
+    }
+  }
+
+  void value(unsigned const depth) {
+    if (depth > kMaxDepth) {
+      fail("nesting too deep");
+    }
+    switch (peek()) {
+      case '{': object(depth); break;
+      case '[': list('[', ']', [&]() { value(depth + 1U); }); break;
+      case '"': string(); break;
+      default: literal();
+    }
+  }
+
+  char const* begin_;
+  char const* pos_;
+  char const* end_;
+  multi_polygon& out_;
+};
+
+}  // namespace
+
+multi_polygon parse_geojson_polygons(std::string_view const str) {
+  multi_polygon out;
+  auto s = geojson_scanner{str.data(), str.data(), str.data() + str.size(),
+                           out};
+  s.value(0U);
+  detail::skip_spaces(s.pos_, s.end_);
+  if (s.pos_ != s.end_) {
+    s.fail("trailing characters");
+  }
+  return out;
+}
+
+multi_polygon read_geojson_polygons(std::string const& filename) {
+  auto const file = detail::map_file(filename);
+  return parse_geojson_polygons(file.view());
+}
+
+}  // namespace geo
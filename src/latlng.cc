@@ -2,10 +2,7 @@
 
 #include <cmath>
 
-#include "boost/geometry.hpp"
-
 #include "geo/constants.h"
-#include "geo/detail/register_latlng.h"
 #include "geo/tile.h"
 #include "geo/webmercator.h"
 
@@ -27,7 +24,75 @@ std::ostream& operator<<(std::ostream& out, latlng const& pos) {
 }
 
 double distance(latlng const& a, latlng const& b) {
-  return boost::geometry::distance(a, b) * kEarthRadiusMeters;
+  return distance<distance_type::kHaversine>(a, b);
+}
+
+// Vincenty's inverse formula on the WGS84 ellipsoid.
+// https://www.movable-type.co.uk/scripts/latlong-vincenty.html
+// Falls back to the spherical distance for (nearly) antipodal points where
+// the iteration does not converge.
+double vincenty_distance(latlng const& p1, latlng const& p2) {
+  constexpr auto const kA = 6378137.0;
+  constexpr auto const kF = 1.0 / 298.257223563;
+  constexpr auto const kB = (1.0 - kF) * kA;
+
+  auto const l = to_rad(p2.lng_ - p1.lng_);
+  auto const u1 = std::atan((1.0 - kF) * std::tan(to_rad(p1.lat_)));
+  auto const u2 = std::atan((1.0 - kF) * std::tan(to_rad(p2.lat_)));
+  auto const sin_u1 = std::sin(u1);
+  auto const cos_u1 = std::cos(u1);
+  auto const sin_u2 = std::sin(u2);
+  auto const cos_u2 = std::cos(u2);
+
+  auto lambda = l;
+  for (auto i = 0U; i < 200U; ++i) {
+    auto const sin_lambda = std::sin(lambda);
+    auto const cos_lambda = std::cos(lambda);
+    auto const x = cos_u2 * sin_lambda;
+    auto const y = cos_u1 * sin_u2 - sin_u1 * cos_u2 * cos_lambda;
+    auto const sin_sigma = std::sqrt(x * x + y * y);
+    if (sin_sigma == 0.0) {
+      return 0.0;  // coincident points
+    }
+
+    auto const cos_sigma = sin_u1 * sin_u2 + cos_u1 * cos_u2 * cos_lambda;
+    auto const sigma = std::atan2(sin_sigma, cos_sigma);
+    auto const sin_alpha = cos_u1 * cos_u2 * sin_lambda / sin_sigma;
+    auto const cos_sq_alpha = 1.0 - sin_alpha * sin_alpha;
+    auto const cos_2_sigma_m =
+        cos_sq_alpha != 0.0 ? cos_sigma - 2.0 * sin_u1 * sin_u2 / cos_sq_alpha
+                            : 0.0;  // equatorial line
+    auto const c =
+        kF / 16.0 * cos_sq_alpha * (4.0 + kF * (4.0 - 3.0 * cos_sq_alpha));
+
+    auto const prev_lambda = lambda;
+    lambda = l + (1.0 - c) * kF * sin_alpha *
+                     (sigma + c * sin_sigma *
+                                  (cos_2_sigma_m +
+                                   c * cos_sigma *
+                                       (-1.0 + 2.0 * cos_2_sigma_m *
+                                                   cos_2_sigma_m)));
+    if (std::abs(lambda - prev_lambda) > 1e-12) {
+      continue;
+    }
+
+    auto const u_sq = cos_sq_alpha * (kA * kA - kB * kB) / (kB * kB);
+    auto const a =
+        1.0 + u_sq / 16384.0 *
+                  (4096.0 + u_sq * (-768.0 + u_sq * (320.0 - 175.0 * u_sq)));
+    auto const b =
+        u_sq / 1024.0 * (256.0 + u_sq * (-128.0 + u_sq * (74.0 - 47.0 * u_sq)));
+    auto const delta_sigma =
+        b * sin_sigma *
+        (cos_2_sigma_m +
+         b / 4.0 *
+             (cos_sigma * (-1.0 + 2.0 * cos_2_sigma_m * cos_2_sigma_m) -
+              b / 6.0 * cos_2_sigma_m * (-3.0 + 4.0 * sin_sigma * sin_sigma) *
+                  (-3.0 + 4.0 * cos_2_sigma_m * cos_2_sigma_m)));
+    return kB * a * (sigma - delta_sigma);
+  }
+
+  return distance<distance_type::kHaversine>(p1, p2);
 }
 
 double approx_squared_distance(latlng const& a, latlng const& b,
@@ -73,26 +138,24 @@ latlng midpoint(latlng const& a, latlng const& b) {
 }
 
 uint32_t tile_hash_32(latlng const& pos) {
-  uint32_t hash = 0U;
-  constexpr auto const kHashBits = sizeof(hash) * 8;
-  constexpr auto const kZMax = kHashBits / 2;
+  constexpr auto const kZMax = 16U;
+  constexpr auto const kMask = (1U << kZMax) - 1U;
 
   auto const merc = latlng_to_merc(pos);
   using proj = webmercator<1>;
-  tile t{static_cast<uint32_t>(proj::merc_to_pixel_x(merc.x_, kZMax)),
-         static_cast<uint32_t>(proj::merc_to_pixel_y(merc.y_, kZMax)),
-         static_cast<uint32_t>(kZMax)};
-
-  for (auto offset = 0U; offset < kHashBits; offset += 2) {
-    assert(t.z_ != 0);
+  auto const x = static_cast<uint32_t>(proj::merc_to_pixel_x(merc.x_, kZMax));
+  auto const y = static_cast<uint32_t>(proj::merc_to_pixel_y(merc.y_, kZMax));
+  return static_cast<uint32_t>(morton_encode(x & kMask, y & kMask));
+}
 
-    auto quad_pos = t.quad_pos();
-    hash = hash | quad_pos << offset;
-    t = t.parent();
-  }
-  assert(t.z_ == 0);
+uint64_t tile_hash_64(latlng const& pos) {
+  constexpr auto const kScale = 4294967296.0 / (2.0 * kMercOriginShift);
+  constexpr auto const kMax = 4294967295.0;
 
-  return hash;
+  auto const merc = latlng_to_merc(pos);
+  auto const x = std::clamp((merc.x_ + kMercOriginShift) * kScale, 0.0, kMax);
+  auto const y = std::clamp((kMercOriginShift - merc.y_) * kScale, 0.0, kMax);
+  return morton_encode(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
 }
 
 inline double get_angle(merc_xy const& v, merc_xy const& seg_dir,
@@ -1,38 +1,148 @@
 #include "geo/polygon.h"
 
 #include <cmath>
-#include <fstream>
-#include <istream>
+#include <algorithm>
+#include <stdexcept>
 #include <string>
 
 #include "boost/geometry.hpp"
 
 #include "geo/detail/register_latlng.h"
 #include "geo/detail/register_polygon.h"
+#include "geo/detail/text_input.h"
+#include "geo/prepared_polygon.h"
 
 namespace geo {
 
-simple_polygon read_poly_file(std::string const& filename) {
-  std::ifstream in(filename);
-  in.exceptions(std::ios::failbit);
+namespace {
 
-  std::string ignored;
-  std::getline(in, ignored);
-  std::getline(in, ignored);
+// next line without the line break, advances first behind it
+std::string_view next_line(char const*& first, char const* last) {
+  auto const begin = first;
+  auto const end = std::find(first, last, '\n');
+  first = end == last ? last : end + 1;
+  return {begin, static_cast<std::size_t>(end - begin)};
+}
 
-  simple_polygon polygon;
-  while (!in.eof()) {
-    if (in.peek() != ' ' || in.peek() == '\n' || in.eof()) {
-      break;
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && detail::is_space(s.front())) {
+    s.remove_prefix(1U);
+  }
+  while (!s.empty() && detail::is_space(s.back())) {
+    s.remove_suffix(1U);
+  }
+  return s;
+}
+
+// next non-empty line, throws at the end of the input
+std::string_view next_content_line(char const*& first, char const* last) {
+  while (first != last) {
+    auto const line = trim(next_line(first, last));
+    if (!line.empty()) {
+      return line;
+    }
+  }
+  throw std::runtime_error{"poly: missing END"};
+}
+
+// absolute area in squared degrees (only compared)
+double ring_area(simple_polygon const& ring) {
+  auto area = 0.0;
+  for (auto i = std::size_t{0U}, j = ring.size() - 1U; i < ring.size();
+       j = i++) {
+    area += ring[j].lng_ * ring[i].lat_ - ring[i].lng_ * ring[j].lat_;
+  }
+  return std::abs(area) / 2.0;
+}
+
+}  // namespace
+
+multi_polygon parse_poly(std::string_view const str) {
+  auto first = str.data();
+  auto const last = str.data() + str.size();
+  next_line(first, last);  // name
+
+  std::vector<simple_polygon> outers, inners;
+  for (auto section = next_content_line(first, last); section != "END";
+       section = next_content_line(first, last)) {
+    auto& ring = (section.front() == '!' ? inners : outers).emplace_back();
+    for (auto line = next_content_line(first, last); line != "END";
+         line = next_content_line(first, last)) {
+      auto p = line.data();
+      auto const end = line.data() + line.size();
+      auto const lng = detail::parse_double(p, end);
+      detail::skip_spaces(p, end);
+      auto const lat = detail::parse_double(p, end);
+      ring.push_back(latlng{lat, lng});
     }
+  }
+
+  // hole -> innermost (smallest) outer ring containing one of its vertices:
+  // an island inside a hole of an outer ring is also inside that outer ring
+  auto assignment = std::vector<std::size_t>(inners.size(), outers.size());
+  if (!inners.empty()) {
+    auto const prepared =
+        std::vector<prepared_polygon>(begin(outers), end(outers));
+    auto areas = std::vector<double>{};
+    areas.reserve(outers.size());
+    for (auto const& outer : outers) {
+      areas.push_back(ring_area(outer));
+    }
+
+    for (auto i = 0U; i != inners.size(); ++i) {
+      for (auto const& pos : inners[i]) {
+        for (auto j = std::size_t{0U}; j != prepared.size(); ++j) {
+          if ((assignment[i] == outers.size() ||
+               areas[j] < areas[assignment[i]]) &&
+              prepared[j].within(pos)) {
+            assignment[i] = j;
+          }
+        }
+      }
+    }
+  }
+
+  multi_polygon mp;
+  mp.reserve(outers.size());
+  for (auto& outer : outers) {
+    mp.push_back(polygon{std::move(outer), {}});
+  }
+  for (auto i = 0U; i != inners.size(); ++i) {
+    if (assignment[i] != outers.size()) {
+      mp[assignment[i]].inners_.emplace_back(std::move(inners[i]));
+    }
+  }
+  return mp;
+}
+
+multi_polygon read_poly(std::string const& filename) {
+  auto const file = detail::map_file(filename);
+  return parse_poly(file.view());
+}
 
-    double lat = NAN, lng = NAN;
-    in >> lng >> lat;
+simple_polygon read_poly_file(std::string const& filename) {
+  auto const file = detail::map_file(filename);
+  auto const str = file.view();
+  auto first = str.data();
+  auto const last = str.data() + str.size();
+  next_line(first, last);  // name
+  next_line(first, last);  // section
 
-    polygon.emplace_back(geo::latlng{lat, lng});
-    std::getline(in, ignored);
+  // lenient: the ring ends at the first line that is not indented
+  simple_polygon ring;
+  while (first != last && (*first == ' ' || *first == '\t')) {
+    auto const line = trim(next_line(first, last));
+    if (line.empty()) {
+      break;
+    }
+    auto p = line.data();
+    auto const end = line.data() + line.size();
+    auto const lng = detail::parse_double(p, end);
+    detail::skip_spaces(p, end);
+    auto const lat = detail::parse_double(p, end);
+    ring.push_back(latlng{lat, lng});
   }
-  return polygon;
+  return ring;
 }
 
 bool within(latlng const& point, simple_polygon const& polygon) {
@@ -1,8 +1,12 @@
 #include "geo/polyline.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "boost/geometry.hpp"
 
 #include "geo/constants.h"
+#include "geo/simplify_mask.h"
 
 #include "geo/detail/register_latlng.h"
 #include "geo/detail/register_polyline.h"
@@ -19,6 +23,74 @@ polyline simplify(polyline const& p, double const max_distance) {
   return result;
 }
 
+polyline simplify_metric(polyline const& p, double const max_distance_meters) {
+  if (p.size() < 3U) {
+    return p;
+  }
+
+  auto lat_min = p.front().lat_;
+  auto lat_max = p.front().lat_;
+  for (auto const& pos : p) {
+    lat_min = std::min(lat_min, pos.lat_);
+    lat_max = std::max(lat_max, pos.lat_);
+  }
+
+  constexpr auto kCentimeters = 100.0;
+  auto const ref = p.front();
+  auto const lat_scale = kApproxDistanceLatDegrees * kCentimeters;
+  auto const lng_scale =
+      lat_scale * std::cos(to_rad((lat_min + lat_max) / 2.0));
+
+  std::vector<pixel_xy> projected;
+  projected.reserve(p.size());
+  for (auto const& pos : p) {
+    auto lng_diff = pos.lng_ - ref.lng_;
+    if (lng_diff > 180.0) {
+      lng_diff -= 360.0;
+    } else if (lng_diff < -180.0) {
+      lng_diff += 360.0;
+    }
+    projected.emplace_back(std::llround(lng_diff * lng_scale),
+                           std::llround((pos.lat_ - ref.lat_) * lat_scale));
+  }
+
+  auto const threshold =
+      static_cast<uint64_t>(std::llround(max_distance_meters * kCentimeters));
+  return detail::simplify_projected(p, projected, threshold * threshold);
+}
+
+namespace detail {
+
+polyline simplify_projected(polyline const& p,
+                            std::vector<pixel_xy> const& projected,
+                            uint64_t const squared_threshold) {
+  assert(p.size() == projected.size());
+  if (p.size() < 3U) {
+    return p;
+  }
+
+  std::vector<bool> mask(p.size(), false);
+  mask.front() = true;
+  mask.back() = true;
+
+  std::vector<range_t> stack_mem;
+  stack_mem.reserve(p.size());
+  stack_t stack{stack_mem};
+  process_level(projected, squared_threshold, stack, mask);
+
+  polyline result;
+  result.reserve(static_cast<std::size_t>(
+      std::count(begin(mask), end(mask), true)));
+  for (auto i = 0U; i < p.size(); ++i) {
+    if (mask[i]) {
+      result.push_back(p[i]);
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
 polyline extract(polyline const& p, size_t const from, size_t const to) {
   geo::polyline result;
   result.reserve(std::abs(static_cast<int>(from) - static_cast<int>(to)) + 1);
@@ -0,0 +1,95 @@
+#include "geo/prepared_polygon.h"
+
+#include <algorithm>
+
+namespace geo {
+
+void prepared_polygon::init(std::vector<fixed_latlng> const& ring) {
+  box_ = fixed_box{};
+  band_height_ = 1;
+  band_offsets_.clear();
+  edges_.clear();
+
+  if (ring.size() < 3U) {
+    return;  // empty box: within() is always false
+  }
+
+  box_ = fixed_box::of(ring);
+
+  // horizontal edges never cross the ray
+  std::vector<edge> edges;
+  for (auto i = std::size_t{0U}, j = ring.size() - 1U; i != ring.size();
+       j = i++) {
+    if (ring[j].lat_ != ring[i].lat_) {
+      edges.push_back({ring[j], ring[i]});
+    }
+  }
+
+  auto const band_of = [&](std::int32_t const lat) {
+    return static_cast<std::size_t>((std::int64_t{lat} - box_.min_.lat_) /
+                                    band_height_);
+  };
+
+  // fewer bands while long edges would be copied too often
+  auto const lat_range = std::int64_t{box_.max_.lat_} - box_.min_.lat_ + 1;
+  auto n_bands = static_cast<std::int64_t>(
+      std::max(std::size_t{1U}, edges.size() / kEdgesPerBand));
+  while (true) {
+    band_height_ = (lat_range + n_bands - 1) / n_bands;
+    auto copies = std::size_t{0U};
+    for (auto const& e : edges) {
+      auto const [lo, hi] = std::minmax(e.from_.lat_, e.to_.lat_);
+      copies += band_of(hi) - band_of(lo) + 1U;
+    }
+    if (n_bands == 1 || copies <= kMaxCopiesPerEdge * edges.size()) {
+      break;
+    }
+    n_bands /= 2;
+  }
+
+  // counting sort of the edges into every band they overlap
+  auto const n = band_of(box_.max_.lat_) + 1U;
+  band_offsets_.assign(n + 1U, 0U);
+  for (auto const& e : edges) {
+    auto const [lo, hi] = std::minmax(e.from_.lat_, e.to_.lat_);
+    for (auto b = band_of(lo); b <= band_of(hi); ++b) {
+      ++band_offsets_[b + 1U];
+    }
+  }
+  for (auto b = std::size_t{0U}; b != n; ++b) {
+    band_offsets_[b + 1U] += band_offsets_[b];
+  }
+
+  edges_.resize(band_offsets_.back());
+  auto pos = std::vector<std::size_t>(begin(band_offsets_),
+                                      std::prev(end(band_offsets_)));
+  for (auto const& e : edges) {
+    auto const [lo, hi] = std::minmax(e.from_.lat_, e.to_.lat_);
+    for (auto b = band_of(lo); b <= band_of(hi); ++b) {
+      edges_[pos[b]++] = e;
+    }
+  }
+}
+
+prepared_multi_polygon::prepared_multi_polygon(polygon const& p) { add(p); }
+
+prepared_multi_polygon::prepared_multi_polygon(multi_polygon const& mp) {
+  parts_.reserve(mp.size());
+  for (auto const& p : mp) {
+    add(p);
+  }
+}
+
+void prepared_multi_polygon::add(polygon const& p) {
+  auto& part = parts_.emplace_back();
+  part.outer_ = prepared_polygon{p.outer_};
+  part.inners_.reserve(p.inners_.size());
+  for (auto const& inner : p.inners_) {
+    part.inners_.emplace_back(inner);
+  }
+  if (!part.outer_.box_.empty()) {
+    box_.extend(part.outer_.box_);
+  }
+}
+
+}  // namespace geo
@@ -0,0 +1,279 @@
+#include "geo/prepared_polyline.h"
+
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "geo/constants.h"
+
+namespace geo {
+
+namespace detail {
+
+latlng to_latlng(xyz const& p) {
+  auto const lat = std::atan2(p.z_, std::sqrt(p.x_ * p.x_ + p.y_ * p.y_));
+  return {lat * 180.0 / kPI, std::atan2(p.x_, p.y_) * 180.0 / kPI};
+}
+
+std::pair<xyz, double> project_on_chord(xyz const& q, xyz const& p,
+                                        xyz const& d, double const inv_len_sq) {
+  auto const dot =
+      (q.x_ - p.x_) * d.x_ + (q.y_ - p.y_) * d.y_ + (q.z_ - p.z_) * d.z_;
+  auto const t = std::min(std::max(dot * inv_len_sq, 0.0), 1.0);
+
+  auto const c = xyz{p.x_ + t * d.x_, p.y_ + t * d.y_, p.z_ + t * d.z_};
+  auto const len = std::sqrt(c.x_ * c.x_ + c.y_ * c.y_ + c.z_ * c.z_);
+  auto const scale = len == 0.0 ? 0.0 : 0.5 / len;
+  return {xyz{c.x_ * scale, c.y_ * scale, c.z_ * scale}, t};
+}
+
+void chord_dist_sq(xyz const& q, double const* x, double const* y,
+                   double const* z, double const* dx, double const* dy,
+                   double const* dz, double const* inv, std::size_t const n,
+                   double* out) {
+  auto i = std::size_t{0U};
+
+#if defined(__AVX512F__)
+  {
+    auto const qx = _mm512_set1_pd(q.x_);
+    auto const qy = _mm512_set1_pd(q.y_);
+    auto const qz = _mm512_set1_pd(q.z_);
+    auto const zero = _mm512_setzero_pd();
+    auto const one = _mm512_set1_pd(1.0);
+    for (; i + 8U <= n; i += 8U) {
+      auto const sdx = _mm512_loadu_pd(dx + i);
+      auto const sdy = _mm512_loadu_pd(dy + i);
+      auto const sdz = _mm512_loadu_pd(dz + i);
+      auto const vx = _mm512_sub_pd(qx, _mm512_loadu_pd(x + i));
+      auto const vy = _mm512_sub_pd(qy, _mm512_loadu_pd(y + i));
+      auto const vz = _mm512_sub_pd(qz, _mm512_loadu_pd(z + i));
+      auto const dot = _mm512_add_pd(
+          _mm512_add_pd(_mm512_mul_pd(vx, sdx), _mm512_mul_pd(vy, sdy)),
+          _mm512_mul_pd(vz, sdz));
+      auto const t = _mm512_min_pd(
+          _mm512_max_pd(_mm512_mul_pd(dot, _mm512_loadu_pd(inv + i)), zero),
+          one);
+      auto const ex = _mm512_sub_pd(vx, _mm512_mul_pd(t, sdx));
+      auto const ey = _mm512_sub_pd(vy, _mm512_mul_pd(t, sdy));
+      auto const ez = _mm512_sub_pd(vz, _mm512_mul_pd(t, sdz));
+      _mm512_storeu_pd(
+          out + i,
+          _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(ex, ex),
+                                      _mm512_mul_pd(ey, ey)),
+                        _mm512_mul_pd(ez, ez)));
+    }
+  }
+#endif
+
+#if defined(__AVX2__)
+  {
+    auto const qx = _mm256_set1_pd(q.x_);
+    auto const qy = _mm256_set1_pd(q.y_);
+    auto const qz = _mm256_set1_pd(q.z_);
+    auto const zero = _mm256_setzero_pd();
+    auto const one = _mm256_set1_pd(1.0);
+    for (; i + 4U <= n; i += 4U) {
+      auto const sdx = _mm256_loadu_pd(dx + i);
+      auto const sdy = _mm256_loadu_pd(dy + i);
+      auto const sdz = _mm256_loadu_pd(dz + i);
+      auto const vx = _mm256_sub_pd(qx, _mm256_loadu_pd(x + i));
+      auto const vy = _mm256_sub_pd(qy, _mm256_loadu_pd(y + i));
+      auto const vz = _mm256_sub_pd(qz, _mm256_loadu_pd(z + i));
+      auto const dot = _mm256_add_pd(
+          _mm256_add_pd(_mm256_mul_pd(vx, sdx), _mm256_mul_pd(vy, sdy)),
+          _mm256_mul_pd(vz, sdz));
+      auto const t = _mm256_min_pd(
+          _mm256_max_pd(_mm256_mul_pd(dot, _mm256_loadu_pd(inv + i)), zero),
+          one);
+      auto const ex = _mm256_sub_pd(vx, _mm256_mul_pd(t, sdx));
+      auto const ey = _mm256_sub_pd(vy, _mm256_mul_pd(t, sdy));
+      auto const ez = _mm256_sub_pd(vz, _mm256_mul_pd(t, sdz));
+      _mm256_storeu_pd(
+          out + i,
+          _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ex, ex),
+                                      _mm256_mul_pd(ey, ey)),
+                        _mm256_mul_pd(ez, ez)));
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    auto const vx = q.x_ - x[i];
+    auto const vy = q.y_ - y[i];
+    auto const vz = q.z_ - z[i];
+    auto const dot = vx * dx[i] + vy * dy[i] + vz * dz[i];
+    auto const t = std::min(std::max(dot * inv[i], 0.0), 1.0);
+    auto const ex = vx - t * dx[i];
+    auto const ey = vy - t * dy[i];
+    auto const ez = vz - t * dz[i];
+    out[i] = ex * ex + ey * ey + ez * ez;
+  }
+}
+
+}  // namespace detail
+
+namespace {
+
+void scan(prepared_polyline const& p, xyz const& q, std::size_t const from,
+          std::size_t const to, double& best, std::size_t& best_idx) {
+  constexpr auto const kBlockSize = std::size_t{256U};
+
+  auto buf = std::array<double, kBlockSize>{};
+  for (auto block = from; block < to; block += kBlockSize) {
+    auto const n = std::min(kBlockSize, to - block);
+    detail::chord_dist_sq(q, p.x_.data() + block, p.y_.data() + block,
+                          p.z_.data() + block, p.dx_.data() + block,
+                          p.dy_.data() + block, p.dz_.data() + block,
+                          p.inv_len_sq_.data() + block, n, buf.data());
+    for (auto i = std::size_t{0U}; i < n; ++i) {
+      if (buf[i] < best) {
+        best = buf[i];
+        best_idx = block + i;
+      }
+    }
+  }
+}
+
+polyline_projection project(prepared_polyline const& p, xyz const& q,
+                            std::size_t const i) {
+  auto const start = xyz{p.x_[i], p.y_[i], p.z_[i]};
+  auto const [c, t] = detail::project_on_chord(
+      q, start, xyz{p.dx_[i], p.dy_[i], p.dz_[i]}, p.inv_len_sq_[i]);
+  return {haversine_distance(q, c), detail::to_latlng(c), i, t,
+          p.offsets_[i] + haversine_distance(start, c)};
+}
+
+}  // namespace
+
+void prepared_polyline::init(std::vector<xyz> const& points) {
+  auto const n_segments =
+      points.size() < 2U ? points.size() : points.size() - 1U;
+  for (auto* v : {&x_, &y_, &z_, &dx_, &dy_, &dz_, &inv_len_sq_}) {
+    v->clear();
+    v->reserve(n_segments);
+  }
+  offsets_.clear();
+  offsets_.reserve(points.size());
+
+  for (auto i = 0U; i < n_segments; ++i) {
+    auto const& a = points[i];
+    auto const& b = points.size() == 1U ? points[i] : points[i + 1U];
+    auto const dx = b.x_ - a.x_;
+    auto const dy = b.y_ - a.y_;
+    auto const dz = b.z_ - a.z_;
+    auto const len_sq = dx * dx + dy * dy + dz * dz;
+    x_.push_back(a.x_);
+    y_.push_back(a.y_);
+    z_.push_back(a.z_);
+    dx_.push_back(dx);
+    dy_.push_back(dy);
+    dz_.push_back(dz);
+    inv_len_sq_.push_back(len_sq == 0.0 ? 0.0 : 1.0 / len_sq);
+  }
+
+  auto offset = 0.0;
+  for (auto i = 0U; i < points.size(); ++i) {
+    if (i != 0U) {
+      offset += haversine_distance(points[i - 1U], points[i]);
+    }
+    offsets_.push_back(offset);
+  }
+
+  // leaves (padded to a power of two with empty boxes), then inner nodes
+  auto const n_blocks = (n_segments + kLeafSize - 1U) / kLeafSize;
+  auto n_leaves = std::size_t{1U};
+  while (n_leaves < n_blocks) {
+    n_leaves *= 2U;
+  }
+  first_leaf_ = n_leaves - 1U;
+
+  auto constexpr const kInf = std::numeric_limits<double>::infinity();
+  box_min_.assign(2U * n_leaves - 1U, xyz{kInf, kInf, kInf});
+  box_max_.assign(2U * n_leaves - 1U, xyz{-kInf, -kInf, -kInf});
+
+  auto const extend = [&](std::size_t const node, xyz const& min,
+                          xyz const& max) {
+    auto& n_min = box_min_[node];
+    auto& n_max = box_max_[node];
+    n_min = xyz{std::min(n_min.x_, min.x_), std::min(n_min.y_, min.y_),
+                std::min(n_min.z_, min.z_)};
+    n_max = xyz{std::max(n_max.x_, max.x_), std::max(n_max.y_, max.y_),
+                std::max(n_max.z_, max.z_)};
+  };
+  for (auto i = 0U; i < n_segments; ++i) {
+    auto const node = first_leaf_ + i / kLeafSize;
+    auto const a = xyz{x_[i], y_[i], z_[i]};
+    auto const b = xyz{x_[i] + dx_[i], y_[i] + dy_[i], z_[i] + dz_[i]};
+    extend(node, a, a);
+    extend(node, b, b);
+  }
+  for (auto node = box_min_.size() - 1U; node != 0U; --node) {
+    extend((node - 1U) / 2U, box_min_[node], box_max_[node]);
+  }
+}
+
+polyline_projection prepared_polyline::closest(latlng const& pos) const {
+  if (segment_count() == 0U) {
+    return {std::numeric_limits<double>::infinity(), latlng{}, 0U, 0.0, 0.0};
+  }
+
+  auto const q = xyz{pos};
+  auto best = std::numeric_limits<double>::infinity();
+  auto best_idx = std::size_t{0U};
+
+  // depth first, nearest child first: at most one pending sibling per level
+  auto stack = std::array<std::pair<std::size_t, double>, 64U>{};
+  auto stack_size = std::size_t{0U};
+  stack[stack_size++] = {0U, 0.0};
+  while (stack_size != 0U) {
+    auto const [node, lower_bound] = stack[--stack_size];
+    if (lower_bound >= best) {
+      continue;
+    }
+
+    if (node >= first_leaf_) {
+      auto const from = (node - first_leaf_) * kLeafSize;
+      scan(*this, q, from, std::min(from + kLeafSize, segment_count()), best,
+           best_idx);
+      continue;
+    }
+
+    auto const l = 2U * node + 1U;
+    auto const r = 2U * node + 2U;
+    auto const l_dist = detail::box_dist_sq(q, box_min_[l], box_max_[l]);
+    auto const r_dist = detail::box_dist_sq(q, box_min_[r], box_max_[r]);
+    if (l_dist < r_dist) {
+      stack[stack_size++] = {r, r_dist};
+      stack[stack_size++] = {l, l_dist};
+    } else {
+      stack[stack_size++] = {l, l_dist};
+      stack[stack_size++] = {r, r_dist};
+    }
+  }
+
+  return project(*this, q, best_idx);
+}
+
+polyline_projection prepared_polyline::closest(latlng const& pos,
+                                               std::size_t const segment_idx,
+                                               std::size_t const window) const {
+  if (segment_count() == 0U) {
+    return {std::numeric_limits<double>::infinity(), latlng{}, 0U, 0.0, 0.0};
+  }
+
+  auto const q = xyz{pos};
+  auto const idx = std::min(segment_idx, segment_count() - 1U);
+  auto best = std::numeric_limits<double>::infinity();
+  auto best_idx = idx;
+  scan(*this, q, idx - std::min(idx, window),
+       idx + std::min(window, segment_count() - idx - 1U) + 1U, best,
+       best_idx);
+  return project(*this, q, best_idx);
+}
+
+}  // namespace geo
@@ -0,0 +1,223 @@
+#include "geo/segment_rtree.h"
+
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+
+#include "utl/parallel_for.h"
+
+namespace geo {
+
+namespace {
+
+constexpr auto const kChunkSize = std::size_t{4096U};
+
+// runs fn(i) for i in [0, n) in parallel chunks
+template <typename Fn>
+void parallel_chunks(std::size_t const n, Fn&& fn) {
+  utl::parallel_for_run((n + kChunkSize - 1U) / kChunkSize,
+                        [&](std::size_t const chunk) {
+                          auto const from = chunk * kChunkSize;
+                          auto const to = std::min(from + kChunkSize, n);
+                          for (auto i = from; i < to; ++i) {
+                            fn(i);
+                          }
+                        });
+}
+
+// 21 bits -> every third bit of 63 bits
+std::uint64_t spread_bits(std::uint64_t x) {
+  x &= 0x1FFFFFULL;
+  x = (x | x << 32U) & 0x1F00000000FFFFULL;
+  x = (x | x << 16U) & 0x1F0000FF0000FFULL;
+  x = (x | x << 8U) & 0x100F00F00F00F00FULL;
+  x = (x | x << 4U) & 0x10C30C30C30C30C3ULL;
+  x = (x | x << 2U) & 0x1249249249249249ULL;
+  return x;
+}
+
+std::uint64_t morton_code(xyz const& p) {
+  constexpr auto const kMax = static_cast<double>((1U << 21U) - 1U);
+  auto const quantize = [&](double const v) {
+    return static_cast<std::uint64_t>(std::clamp(v + 0.5, 0.0, 1.0) * kMax);
+  };
+  return spread_bits(quantize(p.x_)) | spread_bits(quantize(p.y_)) << 1U |
+         spread_bits(quantize(p.z_)) << 2U;
+}
+
+}  // namespace
+
+void segment_rtree::init(std::vector<xyz> const& points,
+                         std::vector<std::size_t> const& line_offsets) {
+  auto const n_lines = line_offsets.empty() ? 0U : line_offsets.size() - 1U;
+
+  // meters from the start of the line, per vertex
+  std::vector<double> vertex_offsets(points.size());
+  utl::parallel_for_run(n_lines, [&](std::size_t const l) {
+    auto offset = 0.0;
+    for (auto i = line_offsets[l]; i < line_offsets[l + 1U]; ++i) {
+      if (i != line_offsets[l]) {
+        offset += haversine_distance(points[i - 1U], points[i]);
+      }
+      vertex_offsets[i] = offset;
+    }
+  });
+
+  // segment = first vertex index, sorted by the Morton code of the midpoint
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> segments;
+  for (auto l = 0U; l < n_lines; ++l) {
+    for (auto i = line_offsets[l] + 1U; i < line_offsets[l + 1U]; ++i) {
+      segments.emplace_back(l, static_cast<std::uint32_t>(i - 1U));
+    }
+  }
+
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> keys(segments.size());
+  parallel_chunks(segments.size(), [&](std::size_t const s) {
+    auto const& a = points[segments[s].second];
+    auto const& b = points[segments[s].second + 1U];
+    keys[s] = {morton_code(xyz{(a.x_ + b.x_) / 2.0, (a.y_ + b.y_) / 2.0,
+                               (a.z_ + b.z_) / 2.0}),
+               static_cast<std::uint32_t>(s)};
+  });
+  std::sort(begin(keys), end(keys));
+
+  auto const n = segments.size();
+  for (auto* v : {&x_, &y_, &z_, &dx_, &dy_, &dz_, &inv_len_sq_, &offsets_}) {
+    v->resize(n);
+  }
+  line_idx_.resize(n);
+  segment_idx_.resize(n);
+  parallel_chunks(n, [&](std::size_t const i) {
+    auto const [l, first] = segments[keys[i].second];
+    auto const& a = points[first];
+    auto const& b = points[first + 1U];
+    auto const dx = b.x_ - a.x_;
+    auto const dy = b.y_ - a.y_;
+    auto const dz = b.z_ - a.z_;
+    auto const len_sq = dx * dx + dy * dy + dz * dz;
+    x_[i] = a.x_;
+    y_[i] = a.y_;
+    z_[i] = a.z_;
+    dx_[i] = dx;
+    dy_[i] = dy;
+    dz_[i] = dz;
+    inv_len_sq_[i] = len_sq == 0.0 ? 0.0 : 1.0 / len_sq;
+    offsets_[i] = vertex_offsets[first];
+    line_idx_[i] = l;
+    segment_idx_[i] = static_cast<std::uint32_t>(first - line_offsets[l]);
+  });
+
+  // leaves (padded to a power of two with empty boxes), then inner nodes
+  auto const n_blocks = (n + kLeafSize - 1U) / kLeafSize;
+  auto n_leaves = std::size_t{1U};
+  while (n_leaves < n_blocks) {
+    n_leaves *= 2U;
+  }
+  first_leaf_ = n_leaves - 1U;
+
+  auto constexpr const kInf = std::numeric_limits<double>::infinity();
+  box_min_.assign(2U * n_leaves - 1U, xyz{kInf, kInf, kInf});
+  box_max_.assign(2U * n_leaves - 1U, xyz{-kInf, -kInf, -kInf});
+
+  auto const extend = [&](std::size_t const node, xyz const& min,
+                          xyz const& max) {
+    auto& n_min = box_min_[node];
+    auto& n_max = box_max_[node];
+    n_min = xyz{std::min(n_min.x_, min.x_), std::min(n_min.y_, min.y_),
+                std::min(n_min.z_, min.z_)};
+    n_max = xyz{std::max(n_max.x_, max.x_), std::max(n_max.y_, max.y_),
+                std::max(n_max.z_, max.z_)};
+  };
+  parallel_chunks(n_blocks, [&](std::size_t const block) {
+    auto const node = first_leaf_ + block;
+    for (auto i = block * kLeafSize; i < std::min(n, (block + 1U) * kLeafSize);
+         ++i) {
+      auto const a = xyz{x_[i], y_[i], z_[i]};
+      auto const b = xyz{x_[i] + dx_[i], y_[i] + dy_[i], z_[i] + dz_[i]};
+      extend(node, a, a);
+      extend(node, b, b);
+    }
+  });
+  for (auto node = box_min_.size() - 1U; node != 0U; --node) {
+    extend((node - 1U) / 2U, box_min_[node], box_max_[node]);
+  }
+}
+
+void segment_rtree::nearest(latlng const& pos, unsigned const k,
+                            query_state& state) const {
+  auto& nodes = state.nodes_;
+  auto& candidates = state.candidates_;
+  nodes.clear();
+  candidates.clear();
+  state.results_.clear();
+  if (size() == 0U || k == 0U) {
+    return;
+  }
+
+  auto const q = xyz{pos};
+  auto const is_full = [&]() { return candidates.size() == k; };
+
+  auto buf = std::array<double, kLeafSize>{};
+  nodes.emplace_back(detail::box_dist_sq(q, box_min_[0], box_max_[0]), 0U);
+  while (!nodes.empty()) {
+    std::pop_heap(begin(nodes), end(nodes), std::greater<>{});
+    auto const [lower_bound, node] = nodes.back();
+    nodes.pop_back();
+    if (is_full() && lower_bound >= candidates.front().first) {
+      break;
+    }
+
+    if (node >= first_leaf_) {
+      auto const from = (node - first_leaf_) * kLeafSize;
+      auto const n = std::min(kLeafSize, size() - from);
+      detail::chord_dist_sq(q, x_.data() + from, y_.data() + from,
+                            z_.data() + from, dx_.data() + from,
+                            dy_.data() + from, dz_.data() + from,
+                            inv_len_sq_.data() + from, n, buf.data());
+      for (auto i = std::size_t{0U}; i < n; ++i) {
+        if (!is_full()) {
+          candidates.emplace_back(buf[i], from + i);
+          std::push_heap(begin(candidates), end(candidates));
+        } else if (buf[i] < candidates.front().first) {
+          std::pop_heap(begin(candidates), end(candidates));
+          candidates.back() = {buf[i], from + i};
+          std::push_heap(begin(candidates), end(candidates));
+        }
+      }
+      continue;
+    }
+
+    for (auto const child : {2U * node + 1U, 2U * node + 2U}) {
+      auto const d = detail::box_dist_sq(q, box_min_[child], box_max_[child]);
+      if (d != std::numeric_limits<double>::infinity() &&
+          !(is_full() && d >= candidates.front().first)) {
+        nodes.emplace_back(d, child);
+        std::push_heap(begin(nodes), end(nodes), std::greater<>{});
+      }
+    }
+  }
+
+  for (auto const& [_, i] : candidates) {
+    auto const start = xyz{x_[i], y_[i], z_[i]};
+    auto const [c, t] = detail::project_on_chord(
+        q, start, xyz{dx_[i], dy_[i], dz_[i]}, inv_len_sq_[i]);
+    state.results_.push_back({haversine_distance(q, c), detail::to_latlng(c),
+                              line_idx_[i], segment_idx_[i], t,
+                              offsets_[i] + haversine_distance(start, c)});
+  }
+  std::sort(begin(state.results_), end(state.results_),
+            [](segment_match const& a, segment_match const& b) {
+              return a.distance_ < b.distance_;
+            });
+}
+
+std::vector<segment_match> segment_rtree::nearest(latlng const& pos,
+                                                  unsigned const k) const {
+  auto state = query_state{};
+  nearest(pos, k, state);
+  return std::move(state.results_);
+}
+
+}  // namespace geo
@@ -0,0 +1,161 @@
+#include "geo/simplify_network.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+#include "geo/webmercator.h"
+
+namespace geo {
+
+using node_id_t = uint32_t;
+
+std::vector<simplify_mask_t> make_network_simplify_masks(
+    std::vector<polyline> const& lines, uint32_t const pixel_precision) {
+  using proj = webmercator<4096, kMaxSimplifyZoomLevel>;
+
+  // project every vertex exactly once
+  std::vector<std::size_t> offsets;
+  offsets.reserve(lines.size() + 1);
+  std::vector<pixel_xy> pixels;
+  for (auto const& line : lines) {
+    offsets.push_back(pixels.size());
+    for (auto const& pos : line) {
+      pixels.push_back(
+          proj::merc_to_pixel(latlng_to_merc(pos), kMaxSimplifyZoomLevel));
+    }
+  }
+  offsets.push_back(pixels.size());
+
+  // identical pixel positions -> same node
+  auto const pixel_less = [&](std::size_t const a, std::size_t const b) {
+    return std::tie(pixels[a].x_, pixels[a].y_) <
+           std::tie(pixels[b].x_, pixels[b].y_);
+  };
+  std::vector<std::size_t> order(pixels.size());
+  std::iota(begin(order), end(order), std::size_t{0U});
+  std::sort(begin(order), end(order), pixel_less);
+
+  std::vector<node_id_t> nodes(pixels.size());
+  std::vector<pixel_xy> node_pos;
+  for (auto i = 0U; i < order.size(); ++i) {
+    if (i == 0U || pixel_less(order[i - 1], order[i])) {
+      node_pos.push_back(pixels[order[i]]);
+    }
+    nodes[order[i]] = static_cast<node_id_t>(node_pos.size() - 1U);
+  }
+
+  // junctions: line endpoints and nodes without exactly two neighbours
+  std::vector<std::pair<node_id_t, node_id_t>> edges;
+  for (auto i = 0U; i < lines.size(); ++i) {
+    for (auto j = offsets[i] + 1U; j < offsets[i + 1]; ++j) {
+      auto const a = nodes[j - 1];
+      auto const b = nodes[j];
+      if (a != b) {
+        edges.emplace_back(std::min(a, b), std::max(a, b));
+      }
+    }
+  }
+  std::sort(begin(edges), end(edges));
+  edges.erase(std::unique(begin(edges), end(edges)), end(edges));
+
+  std::vector<uint32_t> degree(node_pos.size(), 0U);
+  for (auto const& [a, b] : edges) {
+    ++degree[a];
+    ++degree[b];
+  }
+
+  std::vector<bool> is_junction(node_pos.size());
+  for (auto i = 0U; i < node_pos.size(); ++i) {
+    is_junction[i] = degree[i] != 2U;
+  }
+  for (auto i = 0U; i < lines.size(); ++i) {
+    if (offsets[i] != offsets[i + 1]) {
+      is_junction[nodes[offsets[i]]] = true;
+      is_junction[nodes[offsets[i + 1] - 1U]] = true;
+    }
+  }
+
+  // split into runs between junctions, simplify each distinct run once
+  std::map<std::vector<node_id_t>, simplify_mask_t> run_masks;
+  std::vector<node_id_t> run_nodes, key;
+  std::vector<std::size_t> run_vertices;
+  std::vector<pixel_xy> run_line;
+
+  std::vector<simplify_mask_t> result;
+  result.reserve(lines.size());
+  for (auto i = 0U; i < lines.size(); ++i) {
+    auto const size = offsets[i + 1] - offsets[i];
+    auto& mask = result.emplace_back(kSimplifyZoomLevels,
+                                     std::vector<bool>(size, false));
+    if (size == 0U) {
+      continue;
+    }
+
+    auto const apply_run = [&]() {
+      if (run_nodes.size() <= 2U) {
+        for (auto& lvl : mask) {
+          for (auto const v : run_vertices) {
+            lvl[v] = true;
+          }
+        }
+        return;
+      }
+
+      auto const reversed =
+          std::lexicographical_compare(rbegin(run_nodes), rend(run_nodes),
+                                       begin(run_nodes), end(run_nodes));
+      key.assign(begin(run_nodes), end(run_nodes));
+      if (reversed) {
+        std::reverse(begin(key), end(key));
+      }
+
+      auto it = run_masks.find(key);
+      if (it == end(run_masks)) {
+        run_line.clear();
+        for (auto const n : key) {
+          run_line.push_back(node_pos[n]);
+        }
+        it = run_masks
+                 .emplace(key, make_simplify_mask(run_line, pixel_precision))
+                 .first;
+      }
+
+      auto const n = run_vertices.size();
+      for (auto z = 0U; z < mask.size(); ++z) {
+        for (auto k = 0U; k < n; ++k) {
+          mask[z][run_vertices[k]] = it->second[z][reversed ? n - 1U - k : k];
+        }
+      }
+    };
+
+    run_nodes = {nodes[offsets[i]]};
+    run_vertices = {0U};
+    for (auto j = 1U; j < size; ++j) {
+      auto const n = nodes[offsets[i] + j];
+      if (n == run_nodes.back()) {
+        continue;
+      }
+      run_nodes.push_back(n);
+      run_vertices.push_back(j);
+      if (is_junction[n]) {
+        apply_run();
+        run_nodes = {n};
+        run_vertices = {j};
+      }
+    }
+    if (run_nodes.size() > 1U) {
+      apply_run();
+    }
+
+    for (auto& lvl : mask) {
+      lvl.front() = true;
+      lvl.back() = true;
+    }
+  }
+
+  return result;
+}
+
+}  // namespace geo
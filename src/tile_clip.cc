@@ -0,0 +1,285 @@
+#include "geo/tile_clip.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace geo {
+
+namespace {
+
+enum outcode : unsigned {
+  kInside = 0U,
+  kLeft = 1U,
+  kRight = 2U,
+  kTop = 4U,
+  kBottom = 8U
+};
+
+unsigned get_outcode(pixel_xy const& p, pixel_bounds const& b) {
+  return (p.x_ < b.minx_ ? kLeft : kInside) |
+         (p.x_ > b.maxx_ ? kRight : kInside) |
+         (p.y_ < b.miny_ ? kTop : kInside) |
+         (p.y_ > b.maxy_ ? kBottom : kInside);
+}
+
+// value of the coordinate a at the position where coordinate b = target
+pixel_coord_t interpolate(pixel_coord_t const a_0, pixel_coord_t const a_1,
+                          pixel_coord_t const b_0, pixel_coord_t const b_1,
+                          pixel_coord_t const target) {
+  auto const t = static_cast<double>(target - b_0) /
+                 static_cast<double>(b_1 - b_0);
+  return a_0 + static_cast<pixel_coord_t>(
+                   std::llround(t * static_cast<double>(a_1 - a_0)));
+}
+
+pixel_xy intersect_x(pixel_xy const& a, pixel_xy const& b,
+                     pixel_coord_t const x) {
+  return {x, interpolate(a.y_, b.y_, a.x_, b.x_, x)};
+}
+
+pixel_xy intersect_y(pixel_xy const& a, pixel_xy const& b,
+                     pixel_coord_t const y) {
+  return {interpolate(a.x_, b.x_, a.y_, b.y_, y), y};
+}
+
+bool clip_segment(pixel_xy& a, pixel_xy& b, pixel_bounds const& bounds) {
+  auto code_a = get_outcode(a, bounds);
+  auto code_b = get_outcode(b, bounds);
+  while (true) {
+    if ((code_a | code_b) == kInside) {
+      return true;
+    }
+    if ((code_a & code_b) != kInside) {
+      return false;
+    }
+
+    auto const code = code_a != kInside ? code_a : code_b;
+    auto const p = (code & kTop) != 0U      ? intersect_y(a, b, bounds.miny_)
+                   : (code & kBottom) != 0U ? intersect_y(a, b, bounds.maxy_)
+                   : (code & kLeft) != 0U   ? intersect_x(a, b, bounds.minx_)
+                                            : intersect_x(a, b, bounds.maxx_);
+    if (code == code_a) {
+      a = p;
+      code_a = get_outcode(a, bounds);
+    } else {
+      b = p;
+      code_b = get_outcode(b, bounds);
+    }
+  }
+}
+
+void remove_duplicates(std::vector<pixel_xy>& ring) {
+  ring.erase(std::unique(begin(ring), end(ring)), end(ring));
+  while (ring.size() > 1U && ring.front() == ring.back()) {
+    ring.pop_back();
+  }
+}
+
+bool has_area(std::vector<pixel_xy> const& ring) {
+  auto area = 0.0;
+  for (auto i = 0U; i < ring.size(); ++i) {
+    auto const& a = ring[i];
+    auto const& b = ring[(i + 1U) % ring.size()];
+    area += static_cast<double>(a.x_) * static_cast<double>(b.y_) -
+            static_cast<double>(b.x_) * static_cast<double>(a.y_);
+  }
+  return area != 0.0;
+}
+
+pixel_coord_t floor_div(pixel_coord_t const a, pixel_coord_t const b) {
+  return a / b - ((a % b != 0) && ((a < 0) != (b < 0)) ? 1 : 0);
+}
+
+struct tile_clipper {
+  using geometry = std::vector<std::vector<pixel_xy>>;
+
+  pixel_bounds bounds(pixel_coord_t const x_0, pixel_coord_t const y_0,
+                      pixel_coord_t const x_1, pixel_coord_t const y_1) const {
+    return {x_0 * tile_size_ - buffer_, y_0 * tile_size_ - buffer_,
+            (x_1 + 1) * tile_size_ + buffer_, (y_1 + 1) * tile_size_ + buffer_};
+  }
+
+  geometry clip(geometry const& g, pixel_bounds const& b) const {
+    if (is_polygon_) {
+      auto ring = clip_ring(g.front(), b);
+      return ring.empty() ? geometry{} : geometry{std::move(ring)};
+    }
+    geometry clipped;
+    for (auto const& part : g) {
+      auto parts = clip_line(part, b);
+      std::move(begin(parts), end(parts), std::back_inserter(clipped));
+    }
+    return clipped;
+  }
+
+  // tiles [x_0, x_1] x [y_0, y_1]
+  void run(geometry const& g, pixel_coord_t const x_0,
+           pixel_coord_t const y_0, pixel_coord_t const x_1,
+           pixel_coord_t const y_1) {
+    if (x_0 == x_1 && y_0 == y_1) {
+      auto& out = result_.emplace_back();
+      out.tile_ = tile{static_cast<std::uint32_t>(x_0),
+                       static_cast<std::uint32_t>(y_0), z_};
+      out.parts_ = g;
+      for (auto& part : out.parts_) {
+        for (auto& p : part) {
+          p.x_ -= x_0 * tile_size_;
+          p.y_ -= y_0 * tile_size_;
+        }
+      }
+      return;
+    }
+
+    auto const recurse = [&](pixel_coord_t const a_x, pixel_coord_t const a_y,
+                             pixel_coord_t const b_x,
+                             pixel_coord_t const b_y) {
+      auto const clipped = clip(g, bounds(a_x, a_y, b_x, b_y));
+      if (!clipped.empty()) {
+        run(clipped, a_x, a_y, b_x, b_y);
+      }
+    };
+    if (x_1 - x_0 >= y_1 - y_0) {
+      auto const mid = x_0 + (x_1 - x_0) / 2;
+      recurse(x_0, y_0, mid, y_1);
+      recurse(mid + 1, y_0, x_1, y_1);
+    } else {
+      auto const mid = y_0 + (y_1 - y_0) / 2;
+      recurse(x_0, y_0, x_1, mid);
+      recurse(x_0, mid + 1, x_1, y_1);
+    }
+  }
+
+  bool is_polygon_;
+  std::uint32_t z_;
+  pixel_coord_t tile_size_, buffer_;
+  std::vector<tile_geometry> result_;
+};
+
+}  // namespace
+
+std::vector<std::vector<pixel_xy>> clip_line(std::vector<pixel_xy> const& line,
+                                             pixel_bounds const& bounds) {
+  std::vector<std::vector<pixel_xy>> parts;
+  std::vector<pixel_xy> current;
+  auto const finish_part = [&]() {
+    if (current.size() > 1U) {
+      parts.emplace_back(std::move(current));
+    }
+    current.clear();
+  };
+
+  for (auto i = 1U; i < line.size(); ++i) {
+    auto a = line[i - 1U];
+    auto b = line[i];
+    if (!clip_segment(a, b, bounds)) {
+      finish_part();
+      continue;
+    }
+
+    if (current.empty() || current.back() != a || a != line[i - 1U]) {
+      finish_part();
+      current.push_back(a);
+    }
+    if (current.back() != b) {
+      current.push_back(b);
+    }
+    if (b != line[i]) {
+      finish_part();
+    }
+  }
+  finish_part();
+  return parts;
+}
+
+std::vector<pixel_xy> clip_ring(std::vector<pixel_xy> const& ring,
+                                pixel_bounds const& bounds) {
+  auto in = ring;
+  std::vector<pixel_xy> out;
+
+  auto const clip_edge = [&](auto&& is_inside, auto&& intersect) {
+    out.clear();
+    for (auto i = 0U; i < in.size(); ++i) {
+      auto const& prev = in[(i + in.size() - 1U) % in.size()];
+      auto const& curr = in[i];
+      if (is_inside(curr)) {
+        if (!is_inside(prev)) {
+          out.push_back(intersect(prev, curr));
+        }
+        out.push_back(curr);
+      } else if (is_inside(prev)) {
+        out.push_back(intersect(prev, curr));
+      }
+    }
+    std::swap(in, out);
+  };
+
+  clip_edge([&](pixel_xy const& p) { return p.x_ >= bounds.minx_; },
+            [&](pixel_xy const& a, pixel_xy const& b) {
+              return intersect_x(a, b, bounds.minx_);
+            });
+  clip_edge([&](pixel_xy const& p) { return p.x_ <= bounds.maxx_; },
+            [&](pixel_xy const& a, pixel_xy const& b) {
+              return intersect_x(a, b, bounds.maxx_);
+            });
+  clip_edge([&](pixel_xy const& p) { return p.y_ >= bounds.miny_; },
+            [&](pixel_xy const& a, pixel_xy const& b) {
+              return intersect_y(a, b, bounds.miny_);
+            });
+  clip_edge([&](pixel_xy const& p) { return p.y_ <= bounds.maxy_; },
+            [&](pixel_xy const& a, pixel_xy const& b) {
+              return intersect_y(a, b, bounds.maxy_);
+            });
+
+  remove_duplicates(in);
+  if (in.size() < 3U || !has_area(in)) {
+    in.clear();
+  }
+  return in;
+}
+
+namespace detail {
+
+std::vector<tile_geometry> clip_to_tiles(std::vector<pixel_xy> const& px,
+                                         bool const is_polygon,
+                                         std::uint32_t const z,
+                                         pixel_coord_t const tile_size,
+                                         pixel_coord_t const buffer) {
+  if (px.size() < (is_polygon ? 3U : 2U)) {
+    return {};
+  }
+
+  auto min = pixel_xy{std::numeric_limits<pixel_coord_t>::max()};
+  auto max = pixel_xy{std::numeric_limits<pixel_coord_t>::min()};
+  for (auto const& p : px) {
+    min = {std::min(min.x_, p.x_), std::min(min.y_, p.y_)};
+    max = {std::max(max.x_, p.x_), std::max(max.y_, p.y_)};
+  }
+
+  auto const max_tile = (pixel_coord_t{1} << z) - 1;
+  auto const to_tile = [&](pixel_coord_t const v) {
+    return std::clamp(floor_div(v, tile_size), pixel_coord_t{0}, max_tile);
+  };
+
+  auto const x_0 = to_tile(min.x_ - buffer);
+  auto const y_0 = to_tile(min.y_ - buffer);
+  auto const x_1 = to_tile(max.x_ + buffer);
+  auto const y_1 = to_tile(max.y_ + buffer);
+
+  auto clipper = tile_clipper{is_polygon, z, tile_size, buffer, {}};
+  auto const clipped = clipper.clip({px}, clipper.bounds(x_0, y_0, x_1, y_1));
+  if (!clipped.empty()) {
+    clipper.run(clipped, x_0, y_0, x_1, y_1);
+  }
+  std::sort(begin(clipper.result_), end(clipper.result_),
+            [](tile_geometry const& a, tile_geometry const& b) {
+              return a.tile_ < b.tile_;
+            });
+  return std::move(clipper.result_);
+}
+
+}  // namespace detail
+
+}  // namespace geo
@@ -0,0 +1,211 @@
+#include "geo/tile_cover.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "geo/webmercator.h"
+
+namespace geo {
+
+namespace {
+
+// fractional tile coordinates on level z
+merc_xy to_tile_xy(latlng const& pos, std::uint32_t const z) {
+  auto const merc = latlng_to_merc(pos);
+  auto const scale =
+      static_cast<double>(std::uint64_t{1U} << z) / (2.0 * kMercOriginShift);
+  return {(merc.x_ + kMercOriginShift) * scale,
+          (kMercOriginShift - merc.y_) * scale};
+}
+
+struct tile_collector {
+  explicit tile_collector(std::uint32_t const z)
+      : z_{z}, max_{static_cast<std::int64_t>(std::uint64_t{1U} << z) - 1} {}
+
+  std::int64_t clamp(double const v) const {
+    return std::clamp(static_cast<std::int64_t>(std::floor(v)),
+                      std::int64_t{0}, max_);
+  }
+
+  void add(std::int64_t const x, std::int64_t const y) {
+    if (x >= 0 && y >= 0 && x <= max_ && y <= max_) {
+      tiles_.emplace_back(morton_encode(static_cast<std::uint32_t>(x),
+                                        static_cast<std::uint32_t>(y)),
+                          z_);
+    }
+  }
+
+  // grid traversal (Amanatides & Woo): every cell the segment passes
+  void add_segment(merc_xy const& a, merc_xy const& b) {
+    auto x = clamp(a.x_);
+    auto y = clamp(a.y_);
+    auto const end_x = clamp(b.x_);
+    auto const end_y = clamp(b.y_);
+    add(x, y);
+
+    auto const dx = b.x_ - a.x_;
+    auto const dy = b.y_ - a.y_;
+    auto const step_x = dx > 0.0 ? 1 : -1;
+    auto const step_y = dy > 0.0 ? 1 : -1;
+
+    // segment parameter t of the next vertical / horizontal cell border
+    auto constexpr const kInf = std::numeric_limits<double>::infinity();
+    auto const border_x = static_cast<double>(x + (dx > 0.0 ? 1 : 0));
+    auto const border_y = static_cast<double>(y + (dy > 0.0 ? 1 : 0));
+    auto t_max_x = dx == 0.0 ? kInf : (border_x - a.x_) / dx;
+    auto t_max_y = dy == 0.0 ? kInf : (border_y - a.y_) / dy;
+    auto const t_delta_x = dx == 0.0 ? kInf : std::abs(1.0 / dx);
+    auto const t_delta_y = dy == 0.0 ? kInf : std::abs(1.0 / dy);
+
+    while ((t_max_x < 1.0 || t_max_y < 1.0) && (x != end_x || y != end_y)) {
+      if (t_max_x < t_max_y) {
+        t_max_x += t_delta_x;
+        x += step_x;
+      } else {
+        t_max_y += t_delta_y;
+        y += step_y;
+      }
+      add(x, y);
+    }
+  }
+
+  std::vector<tile_id> finish() {
+    std::sort(begin(tiles_), end(tiles_));
+    tiles_.erase(std::unique(begin(tiles_), end(tiles_)), end(tiles_));
+    return std::move(tiles_);
+  }
+
+  std::uint32_t z_;
+  std::int64_t max_;
+  std::vector<tile_id> tiles_;
+};
+
+}  // namespace
+
+tile_id tile_at(latlng const& pos, std::uint32_t const z) {
+  auto const c = tile_collector{z};
+  auto const p = to_tile_xy(pos, z);
+  return {morton_encode(static_cast<std::uint32_t>(c.clamp(p.x_)),
+                        static_cast<std::uint32_t>(c.clamp(p.y_))),
+          z};
+}
+
+std::vector<tile_id> tile_cover_line(polyline const& line,
+                                     std::uint32_t const z) {
+  auto c = tile_collector{z};
+  if (line.size() == 1U) {
+    c.tiles_.push_back(tile_at(line.front(), z));
+  }
+  for (auto i = 1U; i < line.size(); ++i) {
+    c.add_segment(to_tile_xy(line[i - 1U], z), to_tile_xy(line[i], z));
+  }
+  return c.finish();
+}
+
+std::vector<tile_id> tile_cover_polygon(simple_polygon const& ring,
+                                        std::uint32_t const z) {
+  auto c = tile_collector{z};
+  if (ring.empty()) {
+    return c.finish();
+  }
+
+  std::vector<merc_xy> points;
+  points.reserve(ring.size());
+  for (auto const& pos : ring) {
+    points.push_back(to_tile_xy(pos, z));
+  }
+
+  // boundary + crossings of the edges with the row centers (half open in y:
+  // vertices on a row center are counted once)
+  std::vector<std::pair<std::int64_t, double>> crossings;
+  for (auto i = 0U; i < points.size(); ++i) {
+    auto const& a = points[i];
+    auto const& b = points[(i + 1U) % points.size()];
+    c.add_segment(a, b);
+
+    if (a.y_ == b.y_) {
+      continue;
+    }
+    auto const min_y = std::min(a.y_, b.y_);
+    auto const max_y = std::max(a.y_, b.y_);
+    auto const first_row = std::max(
+        std::int64_t{0}, static_cast<std::int64_t>(std::ceil(min_y - 0.5)));
+    auto const last_row =
+        std::min(c.max_, static_cast<std::int64_t>(std::ceil(max_y - 0.5)) - 1);
+    auto const inv_slope = (b.x_ - a.x_) / (b.y_ - a.y_);
+    for (auto row = first_row; row <= last_row; ++row) {
+      auto const center_y = static_cast<double>(row) + 0.5;
+      crossings.emplace_back(row, a.x_ + (center_y - a.y_) * inv_slope);
+    }
+  }
+
+  // interior: tiles with their center between two crossings
+  std::sort(begin(crossings), end(crossings));
+  for (auto i = 0U; i + 1U < crossings.size(); i += 2U) {
+    auto const [row, from_x] = crossings[i];
+    auto const to_x = crossings[i + 1U].second;
+    auto const first = std::max(
+        std::int64_t{0}, static_cast<std::int64_t>(std::ceil(from_x - 0.5)));
+    auto const last =
+        std::min(c.max_, static_cast<std::int64_t>(std::ceil(to_x - 0.5)) - 1);
+    for (auto x = first; x <= last; ++x) {
+      c.add(x, row);
+    }
+  }
+
+  return c.finish();
+}
+
+std::vector<tile_id> tile_cover_box(box const& b, std::uint32_t const z) {
+  auto c = tile_collector{z};
+  if (b.empty()) {
+    return c.finish();
+  }
+
+  // y axis points south
+  auto const min = to_tile_xy(latlng{b.max_.lat_, b.min_.lng_}, z);
+  auto const max = to_tile_xy(latlng{b.min_.lat_, b.max_.lng_}, z);
+  auto const max_x = c.clamp(max.x_);
+  auto const max_y = c.clamp(max.y_);
+  c.tiles_.reserve(static_cast<std::size_t>((max_x - c.clamp(min.x_) + 1) *
+                                            (max_y - c.clamp(min.y_) + 1)));
+  for (auto y = c.clamp(min.y_); y <= max_y; ++y) {
+    for (auto x = c.clamp(min.x_); x <= max_x; ++x) {
+      c.add(x, y);
+    }
+  }
+  return c.finish();
+}
+
+std::vector<tile_id> compact_tile_cover(std::vector<tile_id> const& cover,
+                                        std::uint32_t const min_z) {
+  std::vector<tile_id> compact;
+  std::vector<tile_id> parents;
+  auto level = cover;
+  while (!level.empty()) {
+    if (level.front().z() <= min_z) {
+      compact.insert(end(compact), begin(level), end(level));
+      break;
+    }
+
+    parents.clear();
+    for (auto i = 0U; i < level.size();) {
+      // sorted + unique: four siblings are consecutive
+      if (level[i].quad_pos() == 0U && i + 3U < level.size() &&
+          level[i + 3U].morton() == level[i].morton() + 3U) {
+        parents.push_back(level[i].parent());
+        i += 4U;
+      } else {
+        compact.push_back(level[i]);
+        ++i;
+      }
+    }
+    std::swap(level, parents);
+  }
+  std::sort(begin(compact), end(compact));
+  return compact;
+}
+
+}  // namespace geo
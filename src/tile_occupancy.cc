@@ -0,0 +1,81 @@
+#include "geo/tile_occupancy.h"
+
+#include "geo/tile_cover.h"
+
+namespace geo {
+
+tile_occupancy::tile_occupancy(
+    std::vector<std::pair<tile_id, std::uint32_t>> tile_features,
+    std::uint32_t const max_z)
+    : max_z_{max_z}, levels_(max_z + 1U) {
+  auto& pairs = tile_features;
+  std::sort(begin(pairs), end(pairs));
+  pairs.erase(std::unique(begin(pairs), end(pairs)), end(pairs));
+
+  for (auto z = max_z;; --z) {
+    // invariant: pairs sorted and unique
+    auto& level = levels_[z];
+    for (auto const& [tile, feature] : pairs) {
+      if (level.empty() || level.back().tile_ != tile) {
+        level.push_back({tile, 1U});
+      } else {
+        ++level.back().count_;
+      }
+    }
+
+    if (z == 0U) {
+      break;
+    }
+
+    // parents keep the tile order: only features within a parent can repeat
+    for (auto& [tile, feature] : pairs) {
+      tile = tile.parent();
+    }
+    auto out = begin(pairs);
+    for (auto run = begin(pairs); run != end(pairs);) {
+      auto const run_end =
+          std::find_if(run, end(pairs), [&](auto const& p) {
+            return p.first != run->first;
+          });
+      std::sort(run, run_end);
+      auto const unique_end = std::unique(run, run_end);
+      for (; run != unique_end; ++run) {
+        *out++ = *run;
+      }
+      run = run_end;
+    }
+    pairs.erase(out, end(pairs));
+  }
+}
+
+std::uint32_t tile_occupancy::count(tile_id const t) const {
+  if (t.z() > max_z_) {
+    return 0U;
+  }
+  auto const& level = levels_[t.z()];
+  auto const it = std::lower_bound(begin(level), end(level), entry{t, 0U});
+  return it != end(level) && it->tile_ == t ? it->count_ : 0U;
+}
+
+tile_occupancy make_tile_occupancy(std::vector<latlng> const& points,
+                                   std::uint32_t const max_z) {
+  std::vector<std::pair<tile_id, std::uint32_t>> tile_features;
+  tile_features.reserve(points.size());
+  for (auto i = 0U; i < points.size(); ++i) {
+    tile_features.emplace_back(tile_at(points[i], max_z), i);
+  }
+  return tile_occupancy{std::move(tile_features), max_z};
+}
+
+tile_occupancy make_tile_occupancy(std::vector<polyline> const& lines,
+                                   std::uint32_t const max_z) {
+  std::vector<std::pair<tile_id, std::uint32_t>> tile_features;
+  for (auto i = 0U; i < lines.size(); ++i) {
+    for (auto const& t : tile_cover_line(lines[i], max_z)) {
+      tile_features.emplace_back(t, i);
+    }
+  }
+  return tile_occupancy{std::move(tile_features), max_z};
+}
+
+}  // namespace geo
@@ -0,0 +1,74 @@
+#include "geo/tile_partition.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace geo {
+
+tile_pyramid tile_pyramid::full(std::uint32_t const max_z) {
+  return tile_pyramid{make_no_bounds(0U), 0U, max_z};
+}
+
+tile_pyramid tile_pyramid::subtree(tile const& t, std::uint32_t const max_z) {
+  return tile_pyramid{tile_iterator_bounds{t.x_, t.y_, t.x_ + 1U, t.y_ + 1U},
+                      t.z_, max_z};
+}
+
+tile_iterator_bounds tile_pyramid::bounds_on_z(std::uint32_t const z) const {
+  assert(z >= min_z_);
+  auto const dz = z - min_z_;
+  return {bounds_.minx_ << dz, bounds_.miny_ << dz, bounds_.maxx_ << dz,
+          bounds_.maxy_ << dz};
+}
+
+std::uint64_t tile_pyramid::level_size(std::uint32_t const z) const {
+  if (z < min_z_ || z > max_z_) {
+    return 0U;
+  }
+  auto const dz = z - min_z_;
+  return (static_cast<std::uint64_t>(bounds_.maxx_ - bounds_.minx_) << dz) *
+         (static_cast<std::uint64_t>(bounds_.maxy_ - bounds_.miny_) << dz);
+}
+
+std::uint64_t tile_pyramid::size() const {
+  auto size = std::uint64_t{0U};
+  for (auto z = min_z_; z <= max_z_; ++z) {
+    size += level_size(z);
+  }
+  return size;
+}
+
+tile tile_pyramid::at(std::uint64_t i) const {
+  auto z = min_z_;
+  while (i >= level_size(z)) {
+    assert(z <= max_z_);
+    i -= level_size(z);
+    ++z;
+  }
+
+  auto const bounds = bounds_on_z(z);
+  auto const width = static_cast<std::uint64_t>(bounds.maxx_ - bounds.minx_);
+  return {bounds.minx_ + static_cast<std::uint32_t>(i % width),
+          bounds.miny_ + static_cast<std::uint32_t>(i / width), z};
+}
+
+std::vector<tile_partition> tile_partition::split(std::size_t const n) const {
+  std::vector<tile_partition> parts;
+  if (n == 0U) {
+    return parts;
+  }
+
+  auto const base = size() / n;
+  auto const remainder = size() % n;
+  parts.reserve(n);
+  auto from = from_;
+  for (auto k = std::size_t{0U}; k < n; ++k) {
+    auto const to = from + base + (k < remainder ? 1U : 0U);
+    parts.emplace_back(pyramid_, from, to);
+    from = to;
+  }
+  assert(from == to_);
+  return parts;
+}
+
+}  // namespace geo
@@ -0,0 +1,96 @@
+#include "doctest/doctest.h"
+
+#include <random>
+#include <set>
+
+#include "geo/cluster_nearby.h"
+
+TEST_CASE("cluster_nearby") {
+  SUBCASE("empty") { CHECK(geo::cluster_nearby({}, 100.F).empty()); }
+
+  SUBCASE("groups") {
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<double> lat_dist{-80., 80.};
+    std::uniform_real_distribution<double> lng_dist{-180., 180.};
+    std::uniform_real_distribution<double> jitter{-5., 5.};
+
+    // groups of three points with < 15m extent, groups far apart
+    std::vector<geo::latlng> coords;
+    for (auto i = 0U; i < 2'000U; ++i) {
+      auto const center = geo::latlng{lat_dist(gen), lng_dist(gen)};
+      for (auto j = 0U; j < 3U; ++j) {
+        coords.push_back(
+            geo::destination_point(center, jitter(gen) + 5., j * 120.));
+      }
+    }
+
+    auto const clusters = geo::cluster_nearby(coords, 50.F);
+    REQUIRE(clusters.size() == coords.size());
+
+    std::set<geo::cluster_id_t> distinct;
+    for (auto i = 0U; i < coords.size(); i += 3U) {
+      CHECK(clusters[i] == clusters[i + 1]);
+      CHECK(clusters[i] == clusters[i + 2]);
+      distinct.insert(clusters[i]);
+    }
+    CHECK(distinct.size() == coords.size() / 3U);
+
+    CHECK(geo::cluster_nearby(coords, 50.F, true) == clusters);
+  }
+
+  SUBCASE("antimeridian and pole") {
+    auto const clusters = geo::cluster_nearby(
+        {{10., 179.99995}, {10., -179.99995}, {89.99995, 0.}, {89.99995, 180.},
+         {10., 179.9}},
+        50.F);
+    CHECK(clusters[0] == clusters[1]);
+    CHECK(clusters[2] == clusters[3]);
+    CHECK(clusters[0] != clusters[2]);
+    CHECK(clusters[0] != clusters[4]);
+  }
+
+  SUBCASE("threshold") {
+    auto const a = geo::latlng{50., 8.};
+    auto const clusters = geo::cluster_nearby(
+        {a, geo::destination_point(a, 90., 0.),
+         geo::destination_point(a, 110., 180.)},
+        100.F);
+    CHECK(clusters[0] == clusters[1]);
+    CHECK(clusters[0] != clusters[2]);
+  }
+
+  SUBCASE("complete linkage") {
+    // dense single linkage component (chain and blob)
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<double> bearing{0., 360.};
+    std::uniform_real_distribution<double> dist{0., 300.};
+
+    auto const center = geo::latlng{50., 8.};
+    std::vector<geo::latlng> coords;
+    for (auto i = 0U; i < 50U; ++i) {
+      coords.push_back(geo::destination_point(center, i * 30., 90.));
+    }
+    for (auto i = 0U; i < 2'000U; ++i) {
+      coords.push_back(geo::destination_point(center, dist(gen), bearing(gen)));
+    }
+
+    auto const max_dist = 50.F;
+    auto const clusters = geo::cluster_nearby(coords, max_dist);
+    REQUIRE(clusters.size() == coords.size());
+
+    std::set<geo::cluster_id_t> distinct;
+    for (auto i = 0U; i < coords.size(); ++i) {
+      CHECK(clusters[clusters[i]] == clusters[i]);
+      distinct.insert(clusters[i]);
+      for (auto j = 0U; j < i; ++j) {
+        if (clusters[i] == clusters[j]) {
+          CHECK(geo::distance(coords[i], coords[j]) < max_dist + 0.1);
+        }
+      }
+    }
+    CHECK(distinct.size() > 1U);
+    CHECK(distinct.size() < coords.size());
+
+    CHECK(geo::cluster_nearby(coords, max_dist, true) == clusters);
+  }
+}
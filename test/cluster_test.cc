@@ -0,0 +1,221 @@
+#include "doctest/doctest.h"
+
+#include <cstddef>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "geo/cluster.h"
+
+#include "timing.h"
+
+TEST_CASE("cluster_metrics") {
+  auto const a = geo::latlng{50., 8.};
+  for (auto const d : {1., 100., 1000., 10000.}) {
+    auto const b = geo::destination_point(a, d, 30.);
+    CHECK(geo::haversine_metric{}(geo::xyz{a}, geo::xyz{b}) ==
+          doctest::Approx(d).epsilon(1e-6));
+    CHECK(geo::chord_metric{}(geo::xyz{a}, geo::xyz{b}) ==
+          doctest::Approx(d).epsilon(1e-3));
+    CHECK(geo::equirectangular_metric{}(a, b) ==
+          doctest::Approx(d).epsilon(1e-3));
+  }
+  CHECK(geo::equirectangular_metric{}({0., 179.9999}, {0., -179.9999}) ==
+        doctest::Approx(22.24).epsilon(1e-3));
+}
+
+TEST_CASE("cluster_linkage") {
+  std::mt19937 gen{42};
+  std::uniform_real_distribution<double> bearing{0., 360.};
+  std::uniform_real_distribution<double> dist{0., 500.};
+
+  auto const center = geo::latlng{-33.9, 151.2};
+  std::vector<geo::fixed_latlng> coords;
+  for (auto i = 0U; i < 500U; ++i) {
+    coords.push_back(geo::fixed_latlng::from_latlng(
+        geo::destination_point(center, dist(gen), bearing(gen))));
+  }
+
+  auto const max_dist = 40.;
+  auto const index = geo::neighbor_index<>{coords, max_dist};
+  auto const single = geo::make_single_linkage_clusters(index);
+  auto const complete = geo::make_complete_linkage_clusters(index);
+
+  auto const d = [&](std::size_t const i, std::size_t const j) {
+    return geo::distance(coords[i], coords[j]);
+  };
+  for (auto i = 0U; i < coords.size(); ++i) {
+    CHECK(single[single[i]] == single[i]);
+    CHECK(single[i] <= i);
+    CHECK(complete[complete[i]] == complete[i]);
+    CHECK(complete[i] <= i);
+    for (auto j = 0U; j < i; ++j) {
+      if (d(i, j) < max_dist - 0.01) {
+        CHECK(single[i] == single[j]);
+      }
+      if (complete[i] == complete[j]) {
+        CHECK(single[i] == single[j]);
+        CHECK(d(i, j) < max_dist + 0.01);
+      }
+    }
+  }
+}
+
+TEST_CASE("cluster_complete_linkage_reference") {
+  // dense component: every pair is a candidate (distinct distances, no ties)
+  std::mt19937 gen{7};
+  std::uniform_real_distribution<double> bearing{0., 360.};
+  std::uniform_real_distribution<double> dist{0., 60.};
+
+  auto const center = geo::latlng{50., 8.};
+  std::vector<geo::latlng> coords;
+  for (auto i = 0U; i < 200U; ++i) {
+    coords.push_back(geo::destination_point(center, dist(gen), bearing(gen)));
+  }
+
+  auto const max_dist = 50.;
+  auto const index = geo::neighbor_index<>{coords, max_dist};
+  auto const complete = geo::make_complete_linkage_clusters(index);
+
+  // naive O(n^3) reference: always merge the closest pair (dist, i, j)
+  auto const n = coords.size();
+  auto const inf = std::numeric_limits<double>::infinity();
+  std::vector<double> d(n * n, inf);
+  for (auto i = 0U; i < n; ++i) {
+    for (auto j = i + 1U; j < n; ++j) {
+      auto const x = index.metric_(index.points_[i], index.points_[j]);
+      if (x <= max_dist) {
+        d[i * n + j] = d[j * n + i] = x;
+      }
+    }
+  }
+  std::vector<geo::cluster_id_t> expected(n);
+  std::iota(begin(expected), end(expected), geo::cluster_id_t{0U});
+  while (true) {
+    auto best = std::tuple{inf, 0U, 0U};
+    for (auto i = 0U; i < n; ++i) {
+      for (auto j = i + 1U; j < n; ++j) {
+        if (expected[i] == i && expected[j] == j) {
+          best = std::min(best, std::tuple{d[i * n + j], i, j});
+        }
+      }
+    }
+    auto const [x, a, b] = best;
+    if (x == inf) {
+      break;
+    }
+    for (auto c = 0U; c < n; ++c) {
+      d[a * n + c] = d[c * n + a] = std::max(d[a * n + c], d[b * n + c]);
+    }
+    for (auto c = 0U; c < n; ++c) {
+      if (expected[c] == b) {
+        expected[c] = a;
+      }
+    }
+  }
+
+  CHECK(complete == expected);
+  CHECK(geo::make_complete_linkage_clusters(index, 0U) == expected);
+  CHECK(geo::detail::complete_linkage_nn_chain(index) == expected);
+  CHECK(geo::detail::complete_linkage_sparse(index) == expected);
+}
+
+TEST_CASE("cluster_complete_linkage_dense") {
+  // single dense component: O(n^2) close pairs
+  constexpr auto kSize = 3'000U;
+  std::mt19937 gen{3};
+  std::uniform_real_distribution<double> bearing{0., 360.};
+
+  auto const center = geo::latlng{50., 8.};
+  auto const make_coords = [&](double const radius) {
+    std::uniform_real_distribution<double> dist{0., radius};
+    std::vector<geo::latlng> coords;
+    for (auto i = 0U; i < kSize; ++i) {
+      coords.push_back(
+          geo::destination_point(center, dist(gen), bearing(gen)));
+    }
+    return coords;
+  };
+
+  SUBCASE("all within max_dist") {
+    auto const coords = make_coords(45.);
+    auto const index = geo::neighbor_index<>{coords, 100.};
+
+    GEO_START_TIMING(complete);
+    auto const clusters = geo::make_complete_linkage_clusters(index);
+    GEO_STOP_TIMING(complete);
+    std::cout << "complete linkage, " << kSize
+              << " points within max_dist: " << GEO_TIMING_MS(complete)
+              << " ms\n";
+
+    CHECK(clusters == std::vector<geo::cluster_id_t>(kSize, 0U));
+  }
+
+  SUBCASE("nn chain and sparse") {
+    auto const coords = make_coords(300.);
+    auto const max_dist = 100.;
+    auto const index = geo::neighbor_index<>{coords, max_dist};
+
+    GEO_START_TIMING(nn_chain);
+    auto const clusters = geo::detail::complete_linkage_nn_chain(index);
+    GEO_STOP_TIMING(nn_chain);
+
+    GEO_START_TIMING(sparse);
+    auto const sparse = geo::detail::complete_linkage_sparse(index);
+    GEO_STOP_TIMING(sparse);
+
+    std::cout << "complete linkage, " << kSize
+              << " points, nn chain: " << GEO_TIMING_MS(nn_chain)
+              << " ms, sparse: " << GEO_TIMING_MS(sparse) << " ms\n";
+
+    CHECK(clusters == sparse);
+    auto const n_clusters = std::count_if(
+        begin(clusters), end(clusters), [i = 0U](auto const c) mutable {
+          return c == i++;
+        });
+    CHECK(n_clusters > 1);
+    CHECK(n_clusters < static_cast<std::ptrdiff_t>(kSize));
+    for (auto i = 0U; i < kSize; ++i) {
+      for (auto j = 0U; j < i; ++j) {
+        if (clusters[i] == clusters[j]) {
+          CHECK(index.metric_(index.points_[j], index.points_[i]) <=
+                max_dist);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("cluster_dbscan") {
+  auto const a = geo::latlng{48.1, 11.5};
+  auto const b = geo::destination_point(a, 1000., 0.);
+
+  // 0-4: dense around a, 5: border point, 6: noise, 7-8: sparse around b
+  std::vector<geo::latlng> coords{geo::destination_point(a, 1., 0.),
+                                  geo::destination_point(a, 1., 90.),
+                                  geo::destination_point(a, 1., 180.),
+                                  geo::destination_point(a, 1., 270.),
+                                  a,
+                                  geo::destination_point(a, 8., 0.),
+                                  geo::destination_point(a, 500., 0.),
+                                  b,
+                                  geo::destination_point(b, 5., 90.)};
+
+  auto const index =
+      geo::neighbor_index<geo::equirectangular_metric>{coords, 10.};
+
+  auto const unweighted = geo::make_dbscan_clusters(index, 4U);
+  CHECK(unweighted == std::vector<geo::cluster_id_t>{
+                          0U, 0U, 0U, 0U, 0U, 0U, geo::NO_CLUSTER,
+                          geo::NO_CLUSTER, geo::NO_CLUSTER});
+
+  auto const weighted = geo::make_dbscan_clusters(
+      index, 4., std::vector<double>{1., 1., 1., 1., 1., 1., 1., 3.5, 0.5});
+  CHECK(weighted ==
+        std::vector<geo::cluster_id_t>{0U, 0U, 0U, 0U, 0U, 0U,
+                                       geo::NO_CLUSTER, 7U, 7U});
+}
@@ -0,0 +1,118 @@
+#include "doctest/doctest.h"
+
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "geo/compressed_polyline.h"
+#include "geo/latlng.h"
+#include "geo/polyline.h"
+
+#include "timing.h"
+
+using geo::fixed_latlng;
+
+namespace {
+
+// random walk with steps of a few meters
+std::vector<fixed_latlng> make_shape(std::mt19937& gen, std::size_t const n) {
+  std::uniform_real_distribution<> lat_dist{-80., 80.};
+  std::uniform_real_distribution<> lng_dist{-180., 180.};
+  std::uniform_int_distribution<std::int32_t> step_dist{-500, 500};
+
+  auto pos =
+      fixed_latlng::from_latlng(geo::latlng{lat_dist(gen), lng_dist(gen)});
+  std::vector<fixed_latlng> shape;
+  for (auto i = std::size_t{0U}; i != n; ++i) {
+    shape.push_back(pos);
+    pos.lat_ += step_dist(gen);
+    pos.lng_ += step_dist(gen);
+  }
+  return shape;
+}
+
+}  // namespace
+
+TEST_CASE("compressed_polylines round trip") {
+  std::mt19937 gen(0);
+
+  std::vector<std::vector<fixed_latlng>> shapes;
+  for (auto const n : {0U, 1U, 2U, 63U, 64U, 65U, 128U, 1000U}) {
+    shapes.push_back(make_shape(gen, n));
+  }
+  shapes.push_back({fixed_latlng{0, 0},
+                    fixed_latlng{std::numeric_limits<std::int32_t>::min(),
+                                 std::numeric_limits<std::int32_t>::max()},
+                    fixed_latlng{std::numeric_limits<std::int32_t>::max(),
+                                 std::numeric_limits<std::int32_t>::min()},
+                    fixed_latlng::from_latlng(geo::latlng{0.0, 179.9}),
+                    fixed_latlng::from_latlng(geo::latlng{0.0, -179.9})});
+
+  geo::compressed_polylines<> db;
+  for (auto const& s : shapes) {
+    db.emplace_back(s);
+  }
+  REQUIRE(db.size() == shapes.size());
+
+  std::vector<fixed_latlng> decoded;
+  for (auto i = 0U; i != shapes.size(); ++i) {
+    auto const line = db[i];
+    REQUIRE(line.size() == shapes[i].size());
+
+    line.decode(decoded);
+    CHECK(decoded == shapes[i]);
+
+    for (auto j = 0U; j != line.size(); ++j) {
+      CHECK(line[j] == shapes[i][j]);
+    }
+  }
+
+  SUBCASE("latlng input") {
+    auto const line = geo::polyline{{49.8728, 8.6512}, {50.1109, 8.6821}};
+    db.emplace_back(line);
+    auto const decoded_line = db[db.size() - 1U].decode();
+    REQUIRE(decoded_line.size() == 2U);
+    CHECK(decoded_line[0] == fixed_latlng::from_latlng(line[0]));
+    CHECK(decoded_line[1] == fixed_latlng::from_latlng(line[1]));
+  }
+}
+
+TEST_CASE("compressed_polylines size and speed") {
+  constexpr auto const kShapes = 1000U;
+  constexpr auto const kPoints = 500U;
+
+  std::mt19937 gen(0);
+  std::vector<std::vector<fixed_latlng>> shapes;
+  for (auto i = 0U; i != kShapes; ++i) {
+    shapes.push_back(make_shape(gen, kPoints));
+  }
+
+  geo::compressed_polylines<> db;
+  for (auto const& s : shapes) {
+    db.emplace_back(s);
+  }
+
+  auto const bytes_per_point =
+      static_cast<double>(db.size_in_bytes()) / (kShapes * kPoints);
+  CHECK(bytes_per_point < 3.5);
+
+  GEO_START_TIMING(decode);
+  std::vector<fixed_latlng> decoded;
+  auto sum = std::int64_t{0};
+  for (auto i = 0U; i != db.size(); ++i) {
+    db[i].decode(decoded);
+    sum += decoded.back().lat_;
+  }
+  GEO_STOP_TIMING(decode);
+
+  auto expected = std::int64_t{0};
+  for (auto const& s : shapes) {
+    expected += s.back().lat_;
+  }
+  CHECK(sum == expected);
+
+  std::cout << "compressed polylines: " << bytes_per_point
+            << " bytes / point, decoding " << kShapes * kPoints
+            << " points: " << GEO_TIMING_MS(decode) << "ms\n";
+}
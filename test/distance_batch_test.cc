@@ -0,0 +1,131 @@
+#include "doctest/doctest.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "geo/distance_batch.h"
+#include "geo/fixed_latlng.h"
+#include "geo/latlng.h"
+
+#include "timing.h"
+
+TEST_CASE("distance_batch haversine") {
+  constexpr auto kSize = 301;
+  std::vector<geo::latlng> pos;
+  pos.reserve(kSize);
+  {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> lat_dist{-90., 90.};
+    std::uniform_real_distribution<> lng_dist{-180., 180.};
+    for (auto i = 0; i < kSize; ++i) {
+      pos.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+    }
+  }
+
+  auto const soa = geo::xyz_soa{pos};
+  REQUIRE(soa.size() == pos.size());
+
+  GEO_START_TIMING(scalar);
+  std::vector<double> expected;
+  expected.reserve(kSize * kSize);
+  for (auto const& a : pos) {
+    for (auto const& b : pos) {
+      expected.push_back(geo::distance(a, b));
+    }
+  }
+  GEO_STOP_TIMING(scalar);
+  std::cout << "latlng matrix: " << GEO_TIMING_MS(scalar) << " ms\n";
+
+  GEO_START_TIMING(batch);
+  std::vector<double> matrix;
+  geo::haversine_distances(soa, soa, matrix);
+  GEO_STOP_TIMING(batch);
+  std::cout << "batch matrix: " << GEO_TIMING_MS(batch) << " ms\n";
+
+  REQUIRE(matrix.size() == expected.size());
+  for (auto i = 0U; i < matrix.size(); ++i) {
+    CHECK(std::abs(matrix[i] - expected[i]) < 1e-6);
+  }
+
+  std::vector<double> row;
+  for (auto i = 0U; i < pos.size(); i += 37U) {
+    auto const a = geo::xyz{pos[i]};
+    geo::haversine_distances(a, soa, row);
+    REQUIRE(row.size() == pos.size());
+    for (auto j = 0U; j < pos.size(); ++j) {
+      CHECK(row[j] == doctest::Approx(geo::haversine_distance(a, soa[j])));
+    }
+
+    geo::chord_squared_distances(a, soa, row);
+    REQUIRE(row.size() == pos.size());
+    auto const c = soa[7];
+    auto const dx = a.x_ - c.x_;
+    auto const dy = a.y_ - c.y_;
+    auto const dz = a.z_ - c.z_;
+    CHECK(row[7] == doctest::Approx(dx * dx + dy * dy + dz * dz));
+
+    auto const [d, idx] = geo::nearest(a, soa);
+    CHECK(idx == i);
+    CHECK(d < 1e-6);
+  }
+
+  auto const query = geo::latlng{12.3, 45.6};
+  auto const [d, idx] = geo::nearest(geo::xyz{query}, soa);
+  REQUIRE(idx < pos.size());
+  for (auto const& p : pos) {
+    CHECK(d <= geo::distance(query, p) + 1e-6);
+  }
+  CHECK(geo::distance(query, pos[idx]) == doctest::Approx(d));
+
+  CHECK(geo::nearest(geo::xyz{query}, geo::xyz_soa{}).first ==
+        std::numeric_limits<double>::infinity());
+}
+
+TEST_CASE("distance_batch equirectangular") {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<> lat_dist{-80., 80.};
+  std::uniform_real_distribution<> lng_dist{-180., 180.};
+  std::uniform_real_distribution<> dist_dist{0., 10'000.};
+  std::uniform_real_distribution<> bearing_dist{0., 360.};
+
+  for (auto i = 0U; i < 20U; ++i) {
+    auto const a = geo::latlng{lat_dist(gen), lng_dist(gen)};
+
+    std::vector<geo::fixed_latlng> bs;
+    for (auto j = 0U; j < 23U; ++j) {
+      bs.push_back(geo::fixed_latlng::from_latlng(geo::destination_point(
+          a, dist_dist(gen), bearing_dist(gen))));
+    }
+    auto const soa = geo::latlng_soa{bs};
+
+    std::vector<double> out;
+    geo::equirectangular_distances(a, soa, out);
+    REQUIRE(out.size() == bs.size());
+    for (auto j = 0U; j < bs.size(); ++j) {
+      auto const expected = geo::distance(a, bs[j]);
+      CHECK(std::abs(out[j] - expected) <= 0.005 * expected + 0.01);
+
+      auto const scalar =
+          geo::distance<geo::distance_type::kEquirectangular>(a, bs[j]);
+      CHECK(out[j] == doctest::Approx(scalar).epsilon(1e-12));
+    }
+
+    geo::equirectangular_distances(soa, soa, out);
+    REQUIRE(out.size() == bs.size() * bs.size());
+    for (auto j = 0U; j < bs.size(); ++j) {
+      CHECK(out[j * bs.size() + j] == 0.0);
+      for (auto k = 0U; k < bs.size(); ++k) {
+        auto const scalar =
+            geo::distance<geo::distance_type::kEquirectangular>(bs[j], bs[k]);
+        CHECK(out[j * bs.size() + k] == doctest::Approx(scalar).epsilon(1e-12));
+      }
+    }
+  }
+
+  // antimeridian
+  auto const soa = geo::latlng_soa{std::vector<geo::latlng>{{0., -179.9999}}};
+  std::vector<double> out;
+  geo::equirectangular_distances({0., 179.9999}, soa, out);
+  CHECK(out[0] == doctest::Approx(22.24).epsilon(1e-3));
+}
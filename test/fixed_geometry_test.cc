@@ -0,0 +1,167 @@
+#include "doctest/doctest.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "geo/fixed_geometry.h"
+#include "geo/latlng.h"
+#include "geo/polygon.h"
+
+using geo::fixed_latlng;
+
+namespace {
+
+fixed_latlng fix(double const lat, double const lng) {
+  return fixed_latlng::from_latlng(geo::latlng{lat, lng});
+}
+
+// planar reference (geo::within uses great circle edges)
+bool within_double(geo::latlng const& p, geo::simple_polygon const& ring) {
+  auto inside = false;
+  for (auto i = std::size_t{0U}, j = ring.size() - 1U; i < ring.size();
+       j = i++) {
+    auto const& a = ring[j];
+    auto const& b = ring[i];
+    if ((a.lat_ > p.lat_) != (b.lat_ > p.lat_) &&
+        p.lng_ < (b.lng_ - a.lng_) * (p.lat_ - a.lat_) / (b.lat_ - a.lat_) +
+                     a.lng_) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+}  // namespace
+
+TEST_CASE("fixed_box") {
+  auto const coords = std::vector<fixed_latlng>{
+      fix(49.8, 8.6), fix(50.1, 8.7), fix(49.9, 6.9)};
+  auto const b = geo::fixed_box::of(coords);
+  CHECK(b.min_ == fix(49.8, 6.9));
+  CHECK(b.max_ == fix(50.1, 8.7));
+  CHECK(b.contains(fix(50.0, 7.0)));
+  CHECK(b.contains(fix(50.1, 8.7)));
+  CHECK(!b.contains(fix(50.2, 7.0)));
+  CHECK(b.overlaps(geo::fixed_box{fix(50.1, 8.7), fix(51.0, 9.0)}));
+  CHECK(!b.overlaps(geo::fixed_box{fix(50.2, 8.0), fix(51.0, 9.0)}));
+
+  auto expected = geo::box{};
+  for (auto const& c : coords) {
+    expected.extend(c);
+  }
+  CHECK(b.to_box() == expected);
+
+  CHECK(geo::fixed_box{}.empty());
+  CHECK(geo::fixed_box{}.to_box().empty());
+}
+
+TEST_CASE("fixed within") {
+  SUBCASE("compare to double") {
+    // concave ring
+    auto const ring = geo::simple_polygon{
+        {49.0, 8.0}, {49.0, 9.0}, {50.0, 9.0}, {50.0, 8.0},
+        {49.6, 8.0}, {49.6, 8.6}, {49.4, 8.6}, {49.4, 8.0}};
+    std::vector<fixed_latlng> fixed_ring;
+    for (auto const& pos : ring) {
+      fixed_ring.push_back(fixed_latlng::from_latlng(pos));
+    }
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> lat_dist{48.9, 50.1};
+    std::uniform_real_distribution<> lng_dist{7.9, 9.1};
+    for (auto i = 0; i < 10'000; ++i) {
+      auto const p = fix(lat_dist(gen), lng_dist(gen));
+      CHECK(geo::within(p, fixed_ring) ==
+            within_double(static_cast<geo::latlng>(p), ring));
+    }
+  }
+
+  SUBCASE("shared edge") {
+    // two rings sharing the diagonal edge (0, 0) -> (10, 10)
+    auto const a =
+        std::vector<fixed_latlng>{fixed_latlng{0, 0}, fixed_latlng{0, 10},
+                                  fixed_latlng{10, 10}};
+    auto const b =
+        std::vector<fixed_latlng>{fixed_latlng{0, 0}, fixed_latlng{10, 10},
+                                  fixed_latlng{10, 0}};
+    for (auto i = 1; i < 10; ++i) {
+      auto const p = fixed_latlng{i, i};
+      CHECK(geo::within(p, a) != geo::within(p, b));
+    }
+  }
+
+  SUBCASE("extreme coordinates") {
+    // products close to the int64 range must not overflow
+    auto const ring = std::vector<fixed_latlng>{
+        fix(-90.0, -180.0), fix(-90.0, 180.0), fix(90.0, 180.0)};
+    CHECK(geo::within(fix(-45.0, 90.0), ring));
+    CHECK(!geo::within(fix(45.0, -90.0), ring));
+    CHECK(geo::within(fix(89.9, 179.95), ring));
+    CHECK(!geo::within(fix(89.9, 179.7), ring));
+  }
+
+  SUBCASE("degenerate") {
+    CHECK(!geo::within(fix(0.0, 0.0), std::vector<fixed_latlng>{}));
+    CHECK(!geo::within(fix(0.0, 0.0),
+                       std::vector<fixed_latlng>{fix(0, 0), fix(1, 1)}));
+  }
+}
+
+TEST_CASE("fixed_distance_approx") {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<> lat_dist{-80., 80.};
+  std::uniform_real_distribution<> lng_dist{-180., 180.};
+  std::uniform_real_distribution<> bearing_dist{0., 360.};
+  std::uniform_real_distribution<> dist_dist{10., 10'000.};
+
+  for (auto i = 0; i < 10'000; ++i) {
+    auto const a = geo::latlng{lat_dist(gen), lng_dist(gen)};
+    auto const b =
+        geo::destination_point(a, dist_dist(gen), bearing_dist(gen));
+    auto const fa = fixed_latlng::from_latlng(a);
+    auto const fb = fixed_latlng::from_latlng(b);
+
+    auto const approx = geo::fixed_distance_approx::at(fa);
+    auto const expected = geo::distance(a, b);
+    auto const actual = approx.to_meters(approx.squared_distance(fa, fb));
+    CHECK(std::abs(actual - expected) <= expected * 0.005 + 0.05);
+  }
+
+  auto const approx = geo::fixed_distance_approx{0.0};
+  CHECK(approx.squared_distance(fix(0.0, 179.9), fix(0.0, -179.9)) ==
+        approx.squared_distance(fix(0.0, 0.0), fix(0.0, 0.2)));
+  CHECK(approx.squared_distance(fix(-90.0, -180.0), fix(90.0, 0.0)) ==
+        std::uint64_t{2U} * 1'800'000'000U * 1'800'000'000U);
+}
+
+TEST_CASE("fixed delta encoding") {
+  auto const coords = std::vector<fixed_latlng>{
+      fix(49.8, 8.6),
+      fix(-90.0, -180.0),
+      fix(90.0, 180.0),
+      fixed_latlng{std::numeric_limits<std::int32_t>::min(),
+                   std::numeric_limits<std::int32_t>::max()},
+      fixed_latlng{std::numeric_limits<std::int32_t>::max(),
+                   std::numeric_limits<std::int32_t>::min()},
+      fix(49.8, 8.6)};
+
+  std::vector<fixed_latlng> deltas;
+  geo::delta_encode(coords, deltas);
+  REQUIRE(deltas.size() == coords.size());
+  CHECK(deltas[0] == coords[0]);
+  CHECK(deltas[1] == fixed_latlng{coords[1].lat_ - coords[0].lat_,
+                                  coords[1].lng_ - coords[0].lng_});
+
+  geo::delta_decode(deltas);
+  CHECK(deltas == coords);
+
+  for (auto const x : {0, 1, -1, 12345, -12345,
+                       std::numeric_limits<std::int32_t>::min(),
+                       std::numeric_limits<std::int32_t>::max()}) {
+    CHECK(geo::detail::unzigzag32(geo::detail::zigzag32(x)) == x);
+  }
+  CHECK(geo::detail::zigzag32(-1) == 1U);
+  CHECK(geo::detail::zigzag32(1) == 2U);
+}
@@ -0,0 +1,96 @@
+#include "doctest/doctest.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "geo/geojson.h"
+
+TEST_CASE("parse_geojson_polygons") {
+  SUBCASE("feature collection") {
+    auto const mp = geo::parse_geojson_polygons(R"({
+      "type": "FeatureCollection",
+      "features": [
+        {
+          "type": "Feature",
+          "properties": {"name": "a \"quoted\" [name]", "nested": {"x": [1]}},
+          "geometry": {
+            "type": "Polygon",
+            "coordinates": [
+              [[8.0, 49.0], [9.0, 49.0], [9.0, 50.0], [8.0, 49.0]],
+              [[8.4, 49.2], [8.6, 49.2], [8.6, 49.4], [8.4, 49.2]]
+            ]
+          }
+        },
+        {
+          "type": "Feature",
+          "properties": null,
+          "geometry": {"type": "Point", "coordinates": [1.0, 2.0]}
+        },
+        {
+          "type": "Feature",
+          "properties": {},
+          "geometry": {
+            "coordinates": [
+              [[[1.0, 2.0, 100.0], [3.0, 2.0], [3.0, 4.0], [1.0, 2.0]]],
+              [[[-1e1, -2E1], [-3.5, -2e1], [-3.5, -4.0], [-1e1, -2E1]]]
+            ],
+            "type": "MultiPolygon"
+          }
+        }
+      ]
+    })");
+
+    REQUIRE(mp.size() == 3U);
+    REQUIRE(mp[0].outer_.size() == 4U);
+    CHECK(mp[0].outer_[1] == geo::latlng{49.0, 9.0});
+    REQUIRE(mp[0].inners_.size() == 1U);
+    CHECK(mp[0].inners_[0][2] == geo::latlng{49.4, 8.6});
+
+    CHECK(mp[1].outer_[0] == geo::latlng{2.0, 1.0});
+    CHECK(mp[1].inners_.empty());
+    CHECK(mp[2].outer_[1] == geo::latlng{-20.0, -3.5});
+  }
+
+  SUBCASE("geometry collection") {
+    auto const mp = geo::parse_geojson_polygons(R"(
+      {"type": "GeometryCollection", "geometries": [
+        {"type": "LineString", "coordinates": [[1, 2], [3, 4]]},
+        {"type": "Polygon", "coordinates": [[[1, 2], [3, 4], [5, 6]]]}
+      ]})");
+    REQUIRE(mp.size() == 1U);
+    CHECK(mp[0].outer_ ==
+          geo::simple_polygon{{2.0, 1.0}, {4.0, 3.0}, {6.0, 5.0}});
+  }
+
+  SUBCASE("no polygons") {
+    CHECK(geo::parse_geojson_polygons(R"({"type": "Point",
+        "coordinates": [1, 2]})")
+              .empty());
+    CHECK(geo::parse_geojson_polygons("[]").empty());
+    CHECK(geo::parse_geojson_polygons(
+              R"({"a": [true, false, null, -1.5e3, 0]})")
+              .empty());
+  }
+
+  SUBCASE("malformed") {
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(""), std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(R"({"type": "Polygon")"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(
+        geo::parse_geojson_polygons(
+            R"({"type": "Polygon", "coordinates": [[[1, 2], [3]]]})"),
+        std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(R"({"a": "b"} x)"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(R"({"a": xyz})"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(R"({"a": truex})"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(R"({"a": inf})"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(R"({"a": -inf})"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_geojson_polygons(std::string(1000, '[')),
+                    std::runtime_error);
+  }
+}
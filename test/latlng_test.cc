@@ -1,10 +1,17 @@
 #include "doctest/doctest.h"
 
 #include <array>
+#include <iostream>
+#include <random>
 #include <vector>
 
+#include "boost/geometry.hpp"
+
+#include "geo/detail/register_latlng.h"
 #include "geo/latlng.h"
 
+#include "timing.h"
+
 TEST_CASE("bearing_returns_cw_from_north") {
   CHECK(geo::bearing({0.0, 0.0}, {10.0, 0.0}) == doctest::Approx(0.0));
   CHECK(geo::bearing({0.0, 0.0}, {0.0, 10.0}) == doctest::Approx(90.0));
@@ -217,4 +224,82 @@ TEST_CASE("approx_squaredDistance") {
                    std::sqrt(geo::approx_squared_distance(
                        a, b, geo::approx_distance_lng_degrees(a)))) < eps);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("distance_vincenty") {
+  // Flinders Peak -> Buninyong (Vincenty 1975)
+  auto const flinders = geo::latlng{-(37 + 57 / 60. + 3.72030 / 3600.),
+                                    144 + 25 / 60. + 29.52440 / 3600.};
+  auto const buninyong = geo::latlng{-(37 + 39 / 60. + 10.15610 / 3600.),
+                                     143 + 55 / 60. + 35.38390 / 3600.};
+  CHECK(geo::distance<geo::distance_type::kVincenty>(flinders, buninyong) ==
+        doctest::Approx(54972.271).epsilon(1e-8));
+  CHECK(geo::distance<geo::distance_type::kVincenty>(flinders, flinders) ==
+        0.0);
+
+  // one degree of latitude / longitude at the equator
+  CHECK(geo::distance<geo::distance_type::kVincenty>({0., 0.}, {1., 0.}) ==
+        doctest::Approx(110574.389).epsilon(1e-8));
+  CHECK(geo::distance<geo::distance_type::kVincenty>({0., 0.}, {0., 1.}) ==
+        doctest::Approx(111319.491).epsilon(1e-8));
+
+  // antipodal: no convergence, falls back to the sphere
+  CHECK(geo::distance<geo::distance_type::kVincenty>({0., 0.}, {0.5, 179.7}) ==
+        doctest::Approx(geo::distance({0., 0.}, {0.5, 179.7})).epsilon(1e-2));
+}
+
+TEST_CASE("distance_tiers") {
+  constexpr auto kSize = 10'000;
+  std::vector<geo::latlng> a, b;
+  {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> lat_dist{-80., 80.};
+    std::uniform_real_distribution<> lng_dist{-180., 180.};
+    std::uniform_real_distribution<> dist_dist{0., 10'000.};
+    std::uniform_real_distribution<> bearing_dist{0., 360.};
+    for (auto i = 0; i < kSize; ++i) {
+      a.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+      b.push_back(
+          geo::destination_point(a.back(), dist_dist(gen), bearing_dist(gen)));
+    }
+  }
+
+  auto const run = [&](char const* name, auto&& fn) {
+    std::vector<double> result(kSize);
+    GEO_START_TIMING(timing);
+    for (auto i = 0; i < kSize; ++i) {
+      result[i] = fn(a[i], b[i]);
+    }
+    GEO_STOP_TIMING(timing);
+    std::cout << name << ": " << GEO_TIMING_MS(timing) << " ms\n";
+    return result;
+  };
+
+  auto const reference =
+      run("boost", [](geo::latlng const& x, geo::latlng const& y) {
+        return boost::geometry::distance(x, y) * geo::kEarthRadiusMeters;
+      });
+  auto const haversine = run("haversine", [](auto const& x, auto const& y) {
+    return geo::distance<geo::distance_type::kHaversine>(x, y);
+  });
+  auto const chord = run("chord", [](auto const& x, auto const& y) {
+    return geo::distance<geo::distance_type::kChord>(x, y);
+  });
+  auto const equirectangular =
+      run("equirectangular", [](auto const& x, auto const& y) {
+        return geo::distance<geo::distance_type::kEquirectangular>(x, y);
+      });
+  auto const vincenty = run("vincenty", [](auto const& x, auto const& y) {
+    return geo::distance<geo::distance_type::kVincenty>(x, y);
+  });
+
+  for (auto i = 0; i < kSize; ++i) {
+    CHECK(std::abs(geo::distance(a[i], b[i]) - reference[i]) < 1e-6);
+    CHECK(std::abs(haversine[i] - reference[i]) < 1e-6);
+    CHECK(std::abs(chord[i] - reference[i]) <= 1e-5 * reference[i] + 1e-6);
+    CHECK(chord[i] <= reference[i] + 1e-6);
+    CHECK(std::abs(equirectangular[i] - reference[i]) <=
+          1e-3 * reference[i] + 1e-6);
+    CHECK(std::abs(vincenty[i] - reference[i]) <= 6e-3 * reference[i] + 1e-6);
+  }
+}
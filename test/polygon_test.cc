@@ -0,0 +1,153 @@
+#include "doctest/doctest.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "geo/polygon.h"
+#include "geo/prepared_polygon.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto const kPoly = R"(germany
+1
+   8.0E+00   4.9E+01
+   9.0   49.0
+	9.0	51.0
+   8.0   51.0
+   8.0E+00   4.9E+01
+END
+!2
+   8.4   49.4
+   8.6   49.4
+   8.6   49.6
+   8.4   49.4
+END
+
+area_3
+   20.0   10.0
+   21.0   10.0
+   21.0   11.0
+END
+!outside
+   30.0   30.0
+   31.0   30.0
+   31.0   31.0
+END
+END
+)";
+
+}  // namespace
+
+TEST_CASE("parse_poly") {
+  SUBCASE("multiple rings and holes") {
+    auto const mp = geo::parse_poly(kPoly);
+    REQUIRE(mp.size() == 2U);
+
+    REQUIRE(mp[0].outer_.size() == 5U);
+    CHECK(mp[0].outer_[0] == geo::latlng{49.0, 8.0});
+    CHECK(mp[0].outer_[2] == geo::latlng{51.0, 9.0});
+    REQUIRE(mp[0].inners_.size() == 1U);
+    CHECK(mp[0].inners_[0].size() == 4U);
+    CHECK(mp[0].inners_[0][1] == geo::latlng{49.4, 8.6});
+
+    REQUIRE(mp[1].outer_.size() == 3U);
+    CHECK(mp[1].outer_[1] == geo::latlng{10.0, 21.0});
+    CHECK(mp[1].inners_.empty());
+  }
+
+  SUBCASE("island with a lake inside a lake") {
+    // outer, lake, island in the lake, lake on the island
+    auto const mp = geo::parse_poly(R"(lakes
+outer
+  0.0 0.0
+  10.0 0.0
+  10.0 10.0
+  0.0 10.0
+END
+!lake
+  2.0 2.0
+  8.0 2.0
+  8.0 8.0
+  2.0 8.0
+END
+island
+  3.0 3.0
+  7.0 3.0
+  7.0 7.0
+  3.0 7.0
+END
+!island_lake
+  4.0 4.0
+  6.0 4.0
+  6.0 6.0
+  4.0 6.0
+END
+END
+)");
+    REQUIRE(mp.size() == 2U);
+    REQUIRE(mp[0].inners_.size() == 1U);
+    CHECK(mp[0].inners_[0][0] == geo::latlng{2.0, 2.0});
+    REQUIRE(mp[1].inners_.size() == 1U);
+    CHECK(mp[1].inners_[0][0] == geo::latlng{4.0, 4.0});
+
+    auto const prepared = geo::prepared_multi_polygon{mp};
+    CHECK(prepared.within(geo::latlng{1.0, 1.0}));
+    CHECK(!prepared.within(geo::latlng{2.5, 2.5}));
+    CHECK(prepared.within(geo::latlng{3.5, 3.5}));
+    CHECK(!prepared.within(geo::latlng{5.0, 5.0}));
+  }
+
+  SUBCASE("windows line breaks") {
+    auto const mp = geo::parse_poly(
+        "x\r\n1\r\n 1.0 2.0\r\n 3.0 4.0\r\n 5.0 6.0\r\nEND\r\nEND\r\n");
+    REQUIRE(mp.size() == 1U);
+    CHECK(mp[0].outer_ == geo::simple_polygon{{2.0, 1.0}, {4.0, 3.0},
+                                              {6.0, 5.0}});
+  }
+
+  SUBCASE("malformed") {
+    CHECK_THROWS_AS(geo::parse_poly("x\n1\n 1.0 2.0\n"), std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_poly("x\n1\n 1.0 abc\nEND\nEND\n"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(geo::parse_poly(""), std::runtime_error);
+  }
+
+  SUBCASE("read_poly_file") {
+    auto const path = fs::temp_directory_path() / "geo_polygon_test.poly";
+    {
+      std::ofstream out{path};
+      out << kPoly;
+    }
+    auto const ring = geo::read_poly_file(path.generic_string());
+    CHECK(ring == geo::parse_poly(kPoly)[0].outer_);
+    CHECK(geo::read_poly(path.generic_string()).size() == 2U);
+    fs::remove(path);
+
+    CHECK_THROWS_AS(geo::read_poly_file(path.generic_string()),
+                    std::runtime_error);
+  }
+
+  SUBCASE("read_poly_file lenient") {
+    auto const path = fs::temp_directory_path() / "geo_polygon_lenient.poly";
+    {
+      std::ofstream out{path};
+      out << "name\n1\n   1.0   2.0\n   3.0   4.0 trailing\n   5.0 6.0";
+    }
+    CHECK(geo::read_poly_file(path.generic_string()) ==
+          geo::simple_polygon{{2.0, 1.0}, {4.0, 3.0}, {6.0, 5.0}});
+    CHECK_THROWS_AS(geo::read_poly(path.generic_string()), std::runtime_error);
+
+    {
+      std::ofstream out{path};
+      out << "name\n1\n   1.0   2.0\nnot a section\n";
+    }
+    CHECK(geo::read_poly_file(path.generic_string()) ==
+          geo::simple_polygon{{2.0, 1.0}});
+    fs::remove(path);
+  }
+}
@@ -1,7 +1,12 @@
 #include "doctest/doctest.h"
 
+#include <iostream>
+#include <random>
+
 #include "geo/polyline_format.h"
 
+#include "timing.h"
+
 // the official example from :
 // https://developers.google.com/maps/documentation/utilities/polylinealgorithm
 TEST_CASE("polyline_format_google_coord") {
@@ -44,4 +49,246 @@ TEST_CASE("polyline_format_precision_7_overflow") {
   auto const encoded = geo::encode_polyline<7>(original);
   auto const decoded = geo::decode_polyline<7>(encoded);
   CHECK(original == decoded);
-}
\ No newline at end of file
+}
+
+namespace {
+
+// char by char reference implementation (original encoder / decoder)
+std::string reference_encode(geo::polyline const& line) {
+  std::string buf;
+  auto const push_difference = [&](int64_t const diff) {
+    auto tmp = static_cast<int64_t>(static_cast<uint64_t>(diff) << 1);
+    if (diff < 0) {
+      tmp = ~tmp;
+    }
+    for (auto i = 0ULL; i < sizeof(int64_t) * 8; i += 5) {
+      auto curr = tmp & 0b11111;
+      auto const rest = tmp & ~int64_t{0b11111};
+      if (rest != 0) {
+        curr |= 0x20;
+      }
+      buf.push_back(static_cast<char>(curr + 63));
+      tmp = tmp >> 5;
+      if (rest == 0) {
+        break;
+      }
+    }
+  };
+
+  int64_t last_lat = 0, last_lng = 0;
+  for (auto const& ll : line) {
+    int64_t const lat = std::llround(ll.lat_ * 1e5);
+    int64_t const lng = std::llround(ll.lng_ * 1e5);
+    push_difference(lat - last_lat);
+    push_difference(lng - last_lng);
+    last_lat = lat;
+    last_lng = lng;
+  }
+  return buf;
+}
+
+geo::polyline reference_decode(std::string_view const str) {
+  auto const read = [](char const** first, char const* last) {
+    int64_t buf{0};
+    size_t shift = 0;
+    while (*first != last) {
+      int64_t curr = (**first) - 63;
+      buf |= ((curr & 0b11111) << shift);
+      ++(*first);
+      shift += 5;
+      if ((curr & 0x20) == 0) {
+        break;
+      }
+    }
+    return (buf & 1) ? ~(buf >> 1) : (buf >> 1);
+  };
+
+  char const* first = str.data();
+  char const* last = str.data() + str.size();
+  int64_t lat{0}, lng{0};
+  geo::polyline polyline;
+  while (first != last) {
+    lat += read(&first, last);
+    lng += read(&first, last);
+    polyline.emplace_back(geo::latlng{static_cast<double>(lat) / 1e5,
+                                      static_cast<double>(lng) / 1e5});
+  }
+  return polyline;
+}
+
+}  // namespace
+
+TEST_CASE("polyline_format_matches_reference") {
+  constexpr auto kSize = 10'000;
+
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<> step{-0.01, 0.01};
+  std::uniform_real_distribution<> jump{-90.0, 90.0};
+
+  geo::polyline line;
+  auto pos = geo::latlng{49.87, 8.65};
+  for (auto i = 0; i < kSize; ++i) {
+    line.push_back(pos);
+    pos = (i % 1000 == 999) ? geo::latlng{jump(gen), 2.0 * jump(gen)}
+                            : geo::latlng{pos.lat_ + step(gen),
+                                          pos.lng_ + step(gen)};
+  }
+
+  GEO_START_TIMING(reference_encode);
+  auto const expected = reference_encode(line);
+  GEO_STOP_TIMING(reference_encode);
+
+  GEO_START_TIMING(encode);
+  auto const actual = geo::encode_polyline(line);
+  GEO_STOP_TIMING(encode);
+
+  std::cout << "polyline encode reference: "
+            << GEO_TIMING_MS(reference_encode)
+            << " ms, encode: " << GEO_TIMING_MS(encode) << " ms\n";
+  CHECK(expected == actual);
+
+  GEO_START_TIMING(reference_decode);
+  auto const expected_line = reference_decode(actual);
+  GEO_STOP_TIMING(reference_decode);
+
+  GEO_START_TIMING(decode);
+  auto const actual_line = geo::decode_polyline(actual);
+  GEO_STOP_TIMING(decode);
+
+  std::cout << "polyline decode reference: "
+            << GEO_TIMING_MS(reference_decode)
+            << " ms, decode: " << GEO_TIMING_MS(decode) << " ms\n";
+  CHECK(expected_line == actual_line);
+  CHECK(geo::polyline_value_count(actual) == 2U * line.size());
+}
+
+TEST_CASE("polyline_format_encoded_size") {
+  for (auto const diff :
+       {int64_t{0}, int64_t{1}, int64_t{-1}, int64_t{15}, int64_t{16},
+        int64_t{-17}, int64_t{123456789}, std::numeric_limits<int64_t>::max(),
+        std::numeric_limits<int64_t>::min()}) {
+    CAPTURE(diff);
+    geo::polyline_encoder<> enc;
+    enc.push_difference(diff);
+    CHECK(enc.buf_.size() == geo::polyline_encoded_size(diff));
+    CHECK(geo::polyline_value_count(enc.buf_) == 1U);
+
+    for (auto const& str : {enc.buf_, enc.buf_ + "????????"}) {
+      auto first = str.data();
+      CHECK(geo::detail::read_polyline_value(first, str.data() + str.size()) ==
+            diff);
+      CHECK(first == str.data() + enc.buf_.size());
+    }
+  }
+}
+
+TEST_CASE("polyline_format_decode_into") {
+  geo::polyline const original{
+      {38.5, -120.2}, {40.7, -120.95}, {43.252, -126.453}};
+  auto const encoded = geo::encode_polyline(original);
+
+  CHECK(geo::polyline_point_count(encoded) == 3U);
+  CHECK(geo::polyline_point_count("") == 0U);
+
+  SUBCASE("reuse buffer") {
+    geo::polyline buf{{1.0, 2.0}};
+    buf.reserve(16U);
+    auto const data = buf.data();
+    geo::decode_polyline(encoded, buf);
+    CHECK(buf == original);
+    CHECK(buf.data() == data);
+  }
+
+  SUBCASE("sub range") {
+    geo::polyline buf;
+    geo::decode_polyline(encoded, buf, 1U, 2U);
+    REQUIRE(buf.size() == 1U);
+    CHECK(buf[0] == original[1]);
+
+    geo::decode_polyline(encoded, buf, 1U);
+    CHECK(buf == geo::polyline{original[1], original[2]});
+
+    geo::decode_polyline(encoded, buf, 5U);
+    CHECK(buf.empty());
+  }
+
+  SUBCASE("fixed_latlng") {
+    std::vector<geo::fixed_latlng> buf;
+    geo::decode_polyline(encoded, buf);
+    REQUIRE(buf.size() == original.size());
+    for (auto i = 0U; i < buf.size(); ++i) {
+      CHECK(buf[i].lat_ == geo::fixed_latlng::double_to_fix(original[i].lat_));
+      CHECK(buf[i].lng_ == geo::fixed_latlng::double_to_fix(original[i].lng_));
+    }
+  }
+
+  SUBCASE("visitor with early exit") {
+    auto n = 0U;
+    geo::for_each_polyline_point(encoded, [&](geo::latlng const& pos) {
+      CHECK(pos == original[n]);
+      return ++n < 2U;
+    });
+    CHECK(n == 2U);
+
+    auto sum = int64_t{0};
+    geo::for_each_polyline_coordinate(
+        encoded, [&](int64_t const lat, int64_t) { sum += lat; });
+    CHECK(sum == 3850000 + 4070000 + 4325200);
+  }
+}
+
+TEST_CASE("polyline_format_encode_fixed_and_masked") {
+  geo::polyline const original{{38.5, -120.2},
+                               {40.7, -120.95},
+                               {40.70001, -120.95001},
+                               {43.252, -126.453}};
+
+  std::vector<geo::fixed_latlng> fixed;
+  for (auto const& pos : original) {
+    fixed.push_back(geo::fixed_latlng::from_latlng(pos));
+  }
+
+  SUBCASE("fixed_latlng") {
+    CHECK(geo::encode_polyline(original) == geo::encode_polyline(fixed));
+    CHECK(geo::encode_polyline<7>(original) == geo::encode_polyline<7>(fixed));
+
+    geo::polyline_encoder<6> enc;
+    for (auto const& pos : fixed) {
+      enc.push_fixed(pos);
+    }
+    CHECK(enc.buf_ == geo::encode_polyline<6>(original));
+  }
+
+  SUBCASE("fixed_latlng rounding") {
+    CHECK(geo::detail::fixed_to_precision<5>(1234550) == 12346);
+    CHECK(geo::detail::fixed_to_precision<5>(1234549) == 12345);
+    CHECK(geo::detail::fixed_to_precision<5>(-1234550) == -12346);
+    CHECK(geo::detail::fixed_to_precision<5>(-1234549) == -12345);
+    CHECK(geo::detail::fixed_to_precision<7>(-1234549) == -1234549);
+  }
+
+  SUBCASE("mask") {
+    auto const mask = std::vector<bool>{true, false, true, true};
+    auto expected = original;
+    geo::apply_simplify_mask(mask, expected);
+
+    CHECK(geo::encode_polyline(original, mask) ==
+          geo::encode_polyline(expected));
+    CHECK(geo::encode_polyline(fixed, mask) == geo::encode_polyline(expected));
+  }
+
+  SUBCASE("serialized mask") {
+    auto const mask = geo::make_simplify_mask(original);
+    auto const serialized = geo::serialize_simplify_mask(mask);
+
+    for (auto z = 0U; z <= geo::kMaxSimplifyZoomLevel; ++z) {
+      CAPTURE(z);
+      auto expected = original;
+      geo::apply_simplify_mask(serialized, static_cast<int>(z), expected);
+      CHECK(geo::encode_polyline(original, serialized, z) ==
+            geo::encode_polyline(expected));
+      CHECK(geo::encode_polyline(fixed, serialized, z) ==
+            geo::encode_polyline(expected));
+    }
+  }
+}
@@ -86,3 +86,31 @@ TEST_CASE(
     CHECK(distance(closest.best_, expected_point) < 2 * kEpsilon);
   }
 }
+
+TEST_CASE("polylineSimplifyMetric_sameShapeOnDifferentLatitudes_sameResult") {
+  // 2m deviation in the middle of a 200m line
+  auto const make_line = [](latlng const start, double const bearing) {
+    auto const mid = destination_point(start, 100.0, bearing);
+    return polyline{start, destination_point(mid, 2.0, bearing + 90.0),
+                    destination_point(start, 200.0, bearing)};
+  };
+
+  for (auto const lat : {0.0, 45.0, 70.0, -60.0}) {
+    for (auto const lng : {8.0, 179.9995}) {
+      for (auto const bearing : {0.0, 45.0, 90.0}) {
+        CAPTURE(lat);
+        CAPTURE(lng);
+        CAPTURE(bearing);
+        auto const line = make_line(latlng{lat, lng}, bearing);
+        CHECK(simplify_metric(line, 1.8).size() == 3U);
+        CHECK(simplify_metric(line, 2.2).size() == 2U);
+      }
+    }
+  }
+}
+
+TEST_CASE("polylineSimplify_zoomLevel_dropsSubPixelDetail") {
+  auto const line = polyline{{50.0, 8.0}, {50.00001, 8.005}, {50.0, 8.01}};
+  CHECK(simplify<4096>(line, 0).size() == 2U);
+  CHECK(simplify<4096>(line, 20).size() == 3U);
+}
@@ -0,0 +1,244 @@
+#include "doctest/doctest.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "geo/box.h"
+#include "geo/fixed_geometry.h"
+#include "geo/polygon.h"
+#include "geo/polyline.h"
+#include "geo/prepared_polygon.h"
+
+#include "timing.h"
+
+using geo::fixed_latlng;
+
+namespace {
+
+// star shaped ring with random radii around the center
+geo::simple_polygon make_ring(std::mt19937& gen, geo::latlng const& center,
+                              double const radius, std::size_t const n) {
+  std::uniform_real_distribution<> radius_dist{0.2 * radius, radius};
+  geo::simple_polygon ring;
+  for (auto i = std::size_t{0U}; i != n; ++i) {
+    auto const angle = 2.0 * geo::kPI * static_cast<double>(i) /
+                       static_cast<double>(n);
+    auto const r = radius_dist(gen);
+    ring.push_back(geo::latlng{center.lat_ + r * std::sin(angle),
+                               center.lng_ + r * std::cos(angle)});
+  }
+  return ring;
+}
+
+}  // namespace
+
+TEST_CASE("prepared_polygon") {
+  std::mt19937 gen(0);
+
+  SUBCASE("same as fixed within") {
+    for (auto const n : {3U, 4U, 10U, 100U, 1000U}) {
+      auto const ring = make_ring(gen, {50.0, 8.0}, 0.5, n);
+      auto const prepared = geo::prepared_polygon{ring};
+      std::vector<fixed_latlng> fixed;
+      for (auto const& pos : ring) {
+        fixed.push_back(fixed_latlng::from_latlng(pos));
+      }
+
+      std::uniform_real_distribution<> lat_dist{49.4, 50.6};
+      std::uniform_real_distribution<> lng_dist{7.4, 8.6};
+      for (auto i = 0; i < 2000; ++i) {
+        auto const p =
+            fixed_latlng::from_latlng({lat_dist(gen), lng_dist(gen)});
+        CHECK(prepared.within(p) == geo::within(p, fixed));
+      }
+
+      // vertices and edge midpoints: exactly on the boundary
+      for (auto i = std::size_t{0U}; i != fixed.size(); ++i) {
+        auto const& a = fixed[i];
+        auto const& b = fixed[(i + 1U) % fixed.size()];
+        auto const mid = fixed_latlng{a.lat_ + (b.lat_ - a.lat_) / 2,
+                                      a.lng_ + (b.lng_ - a.lng_) / 2};
+        CHECK(prepared.within(a) == geo::within(a, fixed));
+        CHECK(prepared.within(mid) == geo::within(mid, fixed));
+      }
+    }
+  }
+
+  SUBCASE("same as geo::within") {
+    // short edges: straight lines and great circle arcs are close
+    auto const ring = make_ring(gen, {50.0, 8.0}, 0.05, 200U);
+    auto const prepared = geo::prepared_polygon{ring};
+    std::uniform_real_distribution<> lat_dist{49.94, 50.06};
+    std::uniform_real_distribution<> lng_dist{7.94, 8.06};
+    // boost::geometry: clockwise and closed
+    auto closed = geo::simple_polygon{ring.rbegin(), ring.rend()};
+    closed.push_back(closed.front());
+    auto n_inside = 0U;
+    for (auto i = 0; i < 2000; ++i) {
+      auto const p = geo::latlng{lat_dist(gen), lng_dist(gen)};
+      auto const inside = prepared.within(p);
+      n_inside += inside ? 1U : 0U;
+      if (inside != geo::within(p, closed)) {
+        // only directly at the boundary
+        CHECK(geo::distance_to_polyline(p, closed).distance_to_polyline_ <
+              1.0);
+      }
+    }
+    CHECK(n_inside > 0U);
+  }
+
+  SUBCASE("long edges") {
+    // comb: every edge spans the whole latitude range
+    std::vector<fixed_latlng> comb;
+    for (auto i = 0; i != 1000; ++i) {
+      comb.push_back(fixed_latlng{(i % 2) * 10'000'000, i * 10'000});
+    }
+    comb.push_back(fixed_latlng{-1'000'000, 999 * 10'000});
+    comb.push_back(fixed_latlng{-1'000'000, 0});
+    auto const prepared = geo::prepared_polygon{comb};
+    CHECK(prepared.edges_.size() <=
+          geo::prepared_polygon::kMaxCopiesPerEdge * comb.size());
+
+    std::uniform_int_distribution<std::int32_t> lat_dist{-2'000'000,
+                                                         11'000'000};
+    std::uniform_int_distribution<std::int32_t> lng_dist{-10'000,
+                                                         10'000'000};
+    for (auto i = 0; i < 2000; ++i) {
+      auto const p = fixed_latlng{lat_dist(gen), lng_dist(gen)};
+      CHECK(prepared.within(p) == geo::within(p, comb));
+    }
+  }
+
+  SUBCASE("batch") {
+    auto const ring = make_ring(gen, {50.0, 8.0}, 0.5, 100U);
+    auto const prepared = geo::prepared_polygon{ring};
+    std::uniform_real_distribution<> lat_dist{49.4, 50.6};
+    std::uniform_real_distribution<> lng_dist{7.4, 8.6};
+    std::vector<geo::latlng> points;
+    for (auto i = 0; i < 1000; ++i) {
+      points.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+    }
+
+    std::vector<bool> result;
+    prepared.within(points, result);
+    REQUIRE(result.size() == points.size());
+    for (auto i = 0U; i != points.size(); ++i) {
+      CHECK(result[i] == prepared.within(points[i]));
+    }
+  }
+
+  SUBCASE("degenerate") {
+    CHECK(!geo::prepared_polygon{geo::simple_polygon{}}.within(
+        geo::latlng{50.0, 8.0}));
+    CHECK(!geo::prepared_polygon{geo::simple_polygon{{50.0, 8.0},
+                                                     {51.0, 9.0}}}
+               .within(geo::latlng{50.5, 8.5}));
+
+    // horizontal edges, point on the bounding box
+    auto const square = geo::prepared_polygon{geo::simple_polygon{
+        {50.0, 8.0}, {50.0, 9.0}, {51.0, 9.0}, {51.0, 8.0}}};
+    CHECK(square.within(geo::latlng{50.5, 8.5}));
+    CHECK(!square.within(geo::latlng{51.5, 8.5}));
+    CHECK(!square.within(geo::latlng{51.0, 8.5}));
+  }
+}
+
+TEST_CASE("prepared_polygon perf") {
+  constexpr auto const kPoints = 10'000;
+
+  std::mt19937 gen(0);
+  auto const ring = make_ring(gen, {50.0, 8.0}, 0.5, 1000U);
+  auto const prepared = geo::prepared_polygon{ring};
+  auto closed = geo::simple_polygon{ring.rbegin(), ring.rend()};
+  closed.push_back(closed.front());
+
+  std::uniform_real_distribution<> lat_dist{49.4, 50.6};
+  std::uniform_real_distribution<> lng_dist{7.4, 8.6};
+  std::vector<geo::latlng> points;
+  for (auto i = 0; i < kPoints; ++i) {
+    points.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+  }
+
+  GEO_START_TIMING(boost);
+  auto n_boost = 0U;
+  for (auto const& p : points) {
+    n_boost += geo::within(p, closed) ? 1U : 0U;
+  }
+  GEO_STOP_TIMING(boost);
+
+  GEO_START_TIMING(prepared);
+  auto n_prepared = 0U;
+  for (auto const& p : points) {
+    n_prepared += prepared.within(p) ? 1U : 0U;
+  }
+  GEO_STOP_TIMING(prepared);
+
+  CHECK(n_prepared > 0U);
+  CHECK(n_prepared == doctest::Approx(n_boost).epsilon(0.01));
+
+  std::cout << "within " << kPoints << " points, " << ring.size()
+            << " vertices: boost " << GEO_TIMING_MS(boost) << "ms, prepared "
+            << GEO_TIMING_MS(prepared) << "ms\n";
+}
+
+TEST_CASE("prepared_multi_polygon") {
+  auto const square = [](double const lat, double const lng,
+                         double const size) {
+    return geo::simple_polygon{{lat, lng},
+                               {lat, lng + size},
+                               {lat + size, lng + size},
+                               {lat + size, lng}};
+  };
+
+  auto const mp = geo::multi_polygon{
+      geo::polygon{square(50.0, 8.0, 1.0),
+                   {square(50.2, 8.2, 0.2), square(50.6, 8.6, 0.2)}},
+      geo::polygon{square(52.0, 10.0, 0.5), {}}};
+  auto const prepared = geo::prepared_multi_polygon{mp};
+
+  CHECK(prepared.within(geo::latlng{50.1, 8.1}));
+  CHECK(!prepared.within(geo::latlng{50.3, 8.3}));  // hole
+  CHECK(!prepared.within(geo::latlng{50.7, 8.7}));  // hole
+  CHECK(prepared.within(geo::latlng{50.5, 8.5}));
+  CHECK(prepared.within(geo::latlng{52.2, 10.2}));
+  CHECK(!prepared.within(geo::latlng{51.5, 9.5}));  // in the box, no ring
+  CHECK(!prepared.within(geo::latlng{40.0, 8.0}));
+
+  CHECK(prepared.bounding_box() ==
+        geo::make_box({geo::latlng{50.0, 8.0}, geo::latlng{52.5, 10.5}}));
+
+  SUBCASE("same as ring tests") {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> lat_dist{49.9, 52.6};
+    std::uniform_real_distribution<> lng_dist{7.9, 10.6};
+    std::vector<geo::latlng> points;
+    for (auto i = 0; i < 5000; ++i) {
+      points.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+    }
+
+    std::vector<bool> result;
+    prepared.within(points, result);
+    REQUIRE(result.size() == points.size());
+    for (auto i = 0U; i != points.size(); ++i) {
+      auto expected = false;
+      for (auto const& p : mp) {
+        auto const in_ring = [&](geo::simple_polygon const& ring) {
+          return geo::prepared_polygon{ring}.within(points[i]);
+        };
+        expected = expected || (in_ring(p.outer_) &&
+                                std::none_of(begin(p.inners_), end(p.inners_),
+                                             in_ring));
+      }
+      CHECK(result[i] == expected);
+    }
+  }
+
+  SUBCASE("empty") {
+    auto const empty = geo::prepared_multi_polygon{geo::multi_polygon{}};
+    CHECK(!empty.within(geo::latlng{50.0, 8.0}));
+    CHECK(empty.bounding_box().empty());
+  }
+}
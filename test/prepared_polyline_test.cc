@@ -0,0 +1,138 @@
+#include "doctest/doctest.h"
+
+#include <iostream>
+#include <random>
+
+#include "geo/polyline.h"
+#include "geo/prepared_polyline.h"
+
+#include "timing.h"
+
+TEST_CASE("prepared_polyline") {
+  SUBCASE("empty and single point") {
+    auto const empty = geo::prepared_polyline{geo::polyline{}};
+    CHECK(empty.closest({1., 2.}).distance_ ==
+          std::numeric_limits<double>::infinity());
+
+    auto const single = geo::prepared_polyline{geo::polyline{{50., 8.}}};
+    auto const p = single.closest({50.001, 8.});
+    CHECK(p.distance_ ==
+          doctest::Approx(geo::distance({50., 8.}, {50.001, 8.})));
+    CHECK(p.best_ == geo::latlng{50., 8.});
+    CHECK(p.segment_idx_ == 0U);
+    CHECK(p.offset_ == 0.0);
+  }
+
+  SUBCASE("offset") {
+    auto const line = geo::polyline{{0., 0.}, {0., 1.}, {1., 1.}};
+    auto const prepared = geo::prepared_polyline{line};
+    CHECK(prepared.segment_count() == 2U);
+    CHECK(prepared.length() == doctest::Approx(geo::length(line)));
+
+    auto const p = prepared.closest({0.5, 1.1});
+    CHECK(p.segment_idx_ == 1U);
+    CHECK(p.segment_fraction_ == doctest::Approx(0.5).epsilon(1e-3));
+    CHECK(p.best_.lng_ == doctest::Approx(1.));
+    CHECK(p.offset_ == doctest::Approx(geo::distance({0., 0.}, {0., 1.}) +
+                                       geo::distance({0., 1.}, {0.5, 1.}))
+                           .epsilon(1e-6));
+    CHECK(p.distance_ ==
+          doctest::Approx(geo::distance({0.5, 1.1}, p.best_)).epsilon(1e-9));
+  }
+
+  SUBCASE("matches distance_to_polyline") {
+    std::mt19937 gen{0};
+    std::uniform_real_distribution<double> lat_dist{-70., 70.};
+    std::uniform_real_distribution<double> lng_dist{-180., 180.};
+    std::uniform_real_distribution<double> step_dist{10., 300.};
+    std::uniform_real_distribution<double> bearing_dist{0., 360.};
+
+    for (auto i = 0U; i < 50U; ++i) {
+      geo::polyline line{{lat_dist(gen), lng_dist(gen)}};
+      for (auto j = 0U; j < 100U; ++j) {
+        line.push_back(geo::destination_point(line.back(), step_dist(gen),
+                                              bearing_dist(gen)));
+      }
+      auto const prepared = geo::prepared_polyline{line};
+
+      for (auto j = 0U; j < 20U; ++j) {
+        auto const q = geo::destination_point(
+            line[j * 5U], step_dist(gen), bearing_dist(gen));
+        auto const expected = geo::distance_to_polyline(q, line);
+        auto const p = prepared.closest(q);
+        CHECK(std::abs(p.distance_ - expected.distance_to_polyline_) <
+              0.01 + 1e-3 * expected.distance_to_polyline_);
+        CHECK(geo::distance(p.best_, expected.best_) < 0.5);
+        CHECK(p.offset_ >= prepared.offsets_[p.segment_idx_]);
+        CHECK(p.offset_ <= prepared.offsets_[p.segment_idx_ + 1U] + 1e-6);
+      }
+    }
+  }
+}
+
+TEST_CASE("prepared_polyline_long") {
+  constexpr auto kSize = 2'000;
+  constexpr auto kQueries = 200;
+
+  std::mt19937 gen{0};
+  std::uniform_real_distribution<double> step_dist{5., 100.};
+  std::uniform_real_distribution<double> turn_dist{-30., 30.};
+  std::uniform_real_distribution<double> offset_dist{0., 200.};
+  std::uniform_real_distribution<double> bearing_dist{0., 360.};
+
+  geo::polyline line{{52.5, 13.4}};
+  auto bearing = 0.0;
+  for (auto i = 0; i < kSize; ++i) {
+    bearing += turn_dist(gen);
+    line.push_back(
+        geo::destination_point(line.back(), step_dist(gen), bearing));
+  }
+  auto const prepared = geo::prepared_polyline{line};
+
+  std::vector<geo::latlng> queries;
+  for (auto i = 0; i < kQueries; ++i) {
+    queries.push_back(geo::destination_point(
+        line[static_cast<std::size_t>(i) * kSize / kQueries], offset_dist(gen),
+        bearing_dist(gen)));
+  }
+
+  GEO_START_TIMING(linear);
+  std::vector<geo::polyline_candidate> expected;
+  for (auto const& q : queries) {
+    expected.push_back(geo::distance_to_polyline(q, line));
+  }
+  GEO_STOP_TIMING(linear);
+  std::cout << "distance_to_polyline: " << GEO_TIMING_MS(linear) << " ms\n";
+
+  GEO_START_TIMING(bvh);
+  std::vector<geo::polyline_projection> result;
+  for (auto const& q : queries) {
+    result.push_back(prepared.closest(q));
+  }
+  GEO_STOP_TIMING(bvh);
+  std::cout << "prepared_polyline: " << GEO_TIMING_MS(bvh) << " ms\n";
+
+  auto prev_segment = std::size_t{0U};
+  for (auto i = 0; i < kQueries; ++i) {
+    CHECK(std::abs(result[i].distance_ - expected[i].distance_to_polyline_) <
+          0.01 + 1e-3 * expected[i].distance_to_polyline_);
+
+    // sequential trace: search around the previous match
+    auto const windowed = prepared.closest(queries[i], prev_segment, 50U);
+    CHECK(windowed.segment_idx_ + 50U >= prev_segment);
+    CHECK(windowed.segment_idx_ <= prev_segment + 50U);
+    CHECK(windowed.distance_ >= result[i].distance_ - 1e-9);
+    if (result[i].segment_idx_ + 50U >= prev_segment &&
+        result[i].segment_idx_ <= prev_segment + 50U) {
+      CHECK(windowed.distance_ == doctest::Approx(result[i].distance_));
+    }
+    prev_segment = static_cast<std::size_t>(i + 1) * kSize / kQueries;
+  }
+
+  // segments outside of the window are ignored
+  auto const far = prepared.closest(line.back(), 0U, 10U);
+  CHECK(far.segment_idx_ <= 10U);
+  CHECK(far.distance_ > 1'000.0);
+  CHECK(prepared.closest(line.back(), kSize + 5U, 0U).segment_idx_ ==
+        kSize - 1U);
+}
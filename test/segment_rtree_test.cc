@@ -0,0 +1,76 @@
+#include "doctest/doctest.h"
+
+#include <algorithm>
+#include <random>
+
+#include "geo/polyline.h"
+#include "geo/segment_rtree.h"
+
+TEST_CASE("segment_rtree") {
+  std::mt19937 gen{0};
+  std::uniform_real_distribution<double> lat_dist{48.0, 48.2};
+  std::uniform_real_distribution<double> lng_dist{11.4, 11.7};
+  std::uniform_real_distribution<double> step_dist{10., 200.};
+  std::uniform_real_distribution<double> bearing_dist{0., 360.};
+  std::uniform_int_distribution<unsigned> length_dist{0U, 30U};
+
+  std::vector<geo::polyline> lines;
+  for (auto i = 0U; i < 500U; ++i) {
+    auto& line = lines.emplace_back();
+    auto const n = length_dist(gen);
+    if (n != 0U) {
+      line.push_back({lat_dist(gen), lng_dist(gen)});
+    }
+    for (auto j = 1U; j < n; ++j) {
+      line.push_back(geo::destination_point(line.back(), step_dist(gen),
+                                            bearing_dist(gen)));
+    }
+  }
+
+  auto const rtree = geo::segment_rtree{lines};
+
+  auto n_segments = std::size_t{0U};
+  for (auto const& line : lines) {
+    n_segments += line.empty() ? 0U : line.size() - 1U;
+  }
+  CHECK(rtree.size() == n_segments);
+
+  auto state = geo::segment_rtree::query_state{};
+  for (auto i = 0U; i < 200U; ++i) {
+    auto const q = geo::latlng{lat_dist(gen), lng_dist(gen)};
+
+    // brute force: all segments sorted by distance
+    std::vector<std::pair<double, std::pair<std::size_t, std::size_t>>> all;
+    for (auto l = 0U; l < lines.size(); ++l) {
+      for (auto s = 0U; s + 1U < lines[l].size(); ++s) {
+        auto const p = geo::prepared_polyline{
+            geo::polyline{lines[l][s], lines[l][s + 1U]}};
+        all.push_back({p.closest(q).distance_, {l, s}});
+      }
+    }
+    std::sort(begin(all), end(all));
+
+    rtree.nearest(q, 5U, state);
+    auto const& results = state.results_;
+    REQUIRE(results.size() == 5U);
+    for (auto j = 0U; j < results.size(); ++j) {
+      CHECK(results[j].distance_ == doctest::Approx(all[j].first));
+
+      auto const& line = lines[results[j].line_idx_];
+      auto const prepared = geo::prepared_polyline{line};
+      auto const expected =
+          prepared.closest(q, results[j].segment_idx_, 0U);
+      CHECK(results[j].distance_ == doctest::Approx(expected.distance_));
+      CHECK(results[j].offset_ == doctest::Approx(expected.offset_));
+      CHECK(results[j].segment_fraction_ ==
+            doctest::Approx(expected.segment_fraction_));
+      CHECK(geo::distance(results[j].best_, expected.best_) < 1e-6);
+    }
+  }
+
+  CHECK(rtree.nearest({48.1, 11.5}, 0U).empty());
+  CHECK(rtree.nearest({48.1, 11.5}, 100'000U).size() == n_segments);
+  CHECK(geo::segment_rtree{std::vector<geo::polyline>{}}
+            .nearest({48.1, 11.5}, 3U)
+            .empty());
+}
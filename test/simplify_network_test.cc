@@ -0,0 +1,64 @@
+#include "doctest/doctest.h"
+
+#include "geo/simplify_network.h"
+#include "geo/webmercator.h"
+
+TEST_CASE("make_network_simplify_masks") {
+  using proj = geo::webmercator<4096>;
+
+  auto const px2ll = [](auto const x, auto const y) {
+    return geo::merc_to_latlng(proj::pixel_to_merc({x, y}, 0));
+  };
+
+  SUBCASE("single line equals make_simplify_mask") {
+    geo::polyline in{px2ll(0, 0), px2ll(50, 1), px2ll(100, 0),
+                     px2ll(100, 100)};
+
+    auto const out = geo::make_network_simplify_masks({in}, 2);
+    REQUIRE(out.size() == 1);
+    CHECK(out[0] == geo::make_simplify_mask(in, 2));
+  }
+
+  SUBCASE("shared run is simplified identically") {
+    // a: (0,0) -> shared part -> (400, 0)
+    // b: (400, 100) -> reversed shared part -> (0, 100)
+    auto const s0 = px2ll(100, 50);
+    auto const s1 = px2ll(150, 51);
+    auto const s2 = px2ll(200, 50);
+    auto const s3 = px2ll(250, 52);
+    auto const s4 = px2ll(300, 50);
+
+    geo::polyline a{px2ll(0, 0), s0, s1, s2, s3, s4, px2ll(400, 0)};
+    geo::polyline b{px2ll(400, 100), s4, s3, s2, s1, s0, px2ll(0, 100)};
+
+    auto const out = geo::make_network_simplify_masks({a, b, {}}, 4);
+    REQUIRE(out.size() == 3);
+    REQUIRE(out[0].size() == geo::kSimplifyZoomLevels);
+    REQUIRE(out[1].size() == geo::kSimplifyZoomLevels);
+    REQUIRE(out[2].size() == geo::kSimplifyZoomLevels);
+    CHECK(out[2][0].empty());
+
+    for (auto z = 0U; z < geo::kSimplifyZoomLevels; ++z) {
+      CAPTURE(z);
+      REQUIRE(out[0][z].size() == a.size());
+      REQUIRE(out[1][z].size() == b.size());
+
+      // endpoints and junctions are always kept
+      CHECK(out[0][z][0]);
+      CHECK(out[0][z][1]);
+      CHECK(out[0][z][5]);
+      CHECK(out[0][z][6]);
+
+      // shared run has the same mask in both directions
+      for (auto i = 1U; i < 6U; ++i) {
+        CAPTURE(i);
+        CHECK(out[0][z][i] == out[1][z][6U - i]);
+      }
+    }
+
+    // coarse zoom levels drop the inner shared vertices
+    CHECK_FALSE(out[0][0][2]);
+    CHECK_FALSE(out[0][0][3]);
+    CHECK_FALSE(out[0][0][4]);
+  }
+}
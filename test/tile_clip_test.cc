@@ -0,0 +1,206 @@
+#include "doctest/doctest.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "geo/tile_clip.h"
+
+using geo::pixel_xy;
+
+namespace {
+
+// rings are equal up to the start point
+std::vector<pixel_xy> normalize(std::vector<pixel_xy> ring) {
+  std::rotate(begin(ring),
+              std::min_element(begin(ring), end(ring),
+                               [](pixel_xy const& a, pixel_xy const& b) {
+                                 return std::pair{a.x_, a.y_} <
+                                        std::pair{b.x_, b.y_};
+                               }),
+              end(ring));
+  return ring;
+}
+
+}  // namespace
+
+TEST_CASE("clip_line") {
+  auto const b = geo::pixel_bounds{0, 0, 100, 100};
+
+  SUBCASE("crossing") {
+    auto const parts =
+        geo::clip_line({pixel_xy{-50, 50}, pixel_xy{150, 50}}, b);
+    REQUIRE(parts.size() == 1U);
+    CHECK(parts[0] == std::vector<pixel_xy>{{0, 50}, {100, 50}});
+  }
+
+  SUBCASE("inside") {
+    auto const line = std::vector<pixel_xy>{{10, 10}, {20, 30}, {90, 90}};
+    auto const parts = geo::clip_line(line, b);
+    REQUIRE(parts.size() == 1U);
+    CHECK(parts[0] == line);
+  }
+
+  SUBCASE("leave and reenter") {
+    auto const parts = geo::clip_line(
+        {pixel_xy{10, 10}, pixel_xy{10, 200}, pixel_xy{50, 200},
+         pixel_xy{50, 10}},
+        b);
+    REQUIRE(parts.size() == 2U);
+    CHECK(parts[0] == std::vector<pixel_xy>{{10, 10}, {10, 100}});
+    CHECK(parts[1] == std::vector<pixel_xy>{{50, 100}, {50, 10}});
+  }
+
+  SUBCASE("diagonal") {
+    auto const parts = geo::clip_line({pixel_xy{-10, 0}, pixel_xy{0, -10}}, b);
+    CHECK(parts.empty());
+
+    auto const d = geo::clip_line({pixel_xy{-100, -50}, pixel_xy{200, 100}}, b);
+    REQUIRE(d.size() == 1U);
+    CHECK(d[0] == std::vector<pixel_xy>{{0, 0}, {100, 50}});
+  }
+
+  SUBCASE("outside") {
+    CHECK(geo::clip_line({pixel_xy{200, 200}, pixel_xy{300, 300}}, b).empty());
+  }
+}
+
+TEST_CASE("clip_ring") {
+  auto const b = geo::pixel_bounds{0, 0, 100, 100};
+
+  SUBCASE("overlap") {
+    auto const ring = geo::clip_ring(
+        {pixel_xy{50, 50}, pixel_xy{150, 50}, pixel_xy{150, 150},
+         pixel_xy{50, 150}},
+        b);
+    CHECK(normalize(ring) ==
+          std::vector<pixel_xy>{{50, 50}, {100, 50}, {100, 100}, {50, 100}});
+  }
+
+  SUBCASE("contains bounds") {
+    auto const ring = geo::clip_ring(
+        {pixel_xy{-10, -10}, pixel_xy{110, -10}, pixel_xy{110, 110},
+         pixel_xy{-10, 110}},
+        b);
+    CHECK(normalize(ring) ==
+          std::vector<pixel_xy>{{0, 0}, {100, 0}, {100, 100}, {0, 100}});
+  }
+
+  SUBCASE("outside") {
+    CHECK(geo::clip_ring({pixel_xy{200, 200}, pixel_xy{300, 200},
+                          pixel_xy{300, 300}},
+                         b)
+              .empty());
+
+    // bounds in the notch of a concave polygon: degenerate result dropped
+    CHECK(geo::clip_ring({pixel_xy{-50, -50}, pixel_xy{150, -50},
+                          pixel_xy{150, 150}, pixel_xy{120, 150},
+                          pixel_xy{120, -20}, pixel_xy{-20, -20},
+                          pixel_xy{-20, 150}, pixel_xy{-50, 150}},
+                         b)
+              .empty());
+  }
+}
+
+TEST_CASE("clip_to_tiles") {
+  using proj = geo::webmercator<256>;
+  constexpr auto const kZ = 10U;
+  constexpr auto const kBuffer = geo::pixel_coord_t{16};
+
+  auto const check_bounds = [&](std::vector<geo::tile_geometry> const& tiles) {
+    for (auto const& t : tiles) {
+      CHECK(!t.parts_.empty());
+      for (auto const& part : t.parts_) {
+        for (auto const& p : part) {
+          CHECK(p.x_ >= -kBuffer);
+          CHECK(p.y_ >= -kBuffer);
+          CHECK(p.x_ <= proj::kTileSize + kBuffer);
+          CHECK(p.y_ <= proj::kTileSize + kBuffer);
+        }
+      }
+    }
+  };
+
+  SUBCASE("line") {
+    geo::polyline const line{
+        {49.8728, 8.6512}, {50.1109, 8.6821}, {50.9375, 6.9603}};
+    auto const tiles = geo::clip_line_to_tiles<proj>(line, kZ, kBuffer);
+    check_bounds(tiles);
+
+    // same tiles as clipping the projected line to every tile separately
+    std::vector<pixel_xy> px;
+    for (auto const& pos : line) {
+      px.push_back(proj::merc_to_pixel(geo::latlng_to_merc(pos), kZ));
+    }
+    // candidates: tiles of the buffered bounding box of all points
+    auto min = px.front();
+    auto max = px.front();
+    for (auto const& p : px) {
+      min = {std::min(min.x_, p.x_), std::min(min.y_, p.y_)};
+      max = {std::max(max.x_, p.x_), std::max(max.y_, p.y_)};
+    }
+    auto const to_tile = [](geo::pixel_coord_t const v) {
+      return static_cast<std::uint32_t>(v / proj::kTileSize);
+    };
+    std::vector<geo::tile> expected;
+    for (auto const& t : geo::make_tile_range(
+             to_tile(min.x_ - kBuffer), to_tile(min.y_ - kBuffer),
+             to_tile(max.x_ + kBuffer), to_tile(max.y_ + kBuffer), kZ)) {
+      auto const b = proj::tile_bounds_pixel(t.x_, t.y_);
+      if (!geo::clip_line(px, {b.minx_ - kBuffer, b.miny_ - kBuffer,
+                               b.maxx_ + kBuffer, b.maxy_ + kBuffer})
+               .empty()) {
+        expected.push_back(t);
+      }
+    }
+    std::sort(begin(expected), end(expected));
+
+    std::vector<geo::tile> actual;
+    for (auto const& t : tiles) {
+      actual.push_back(t.tile_);
+    }
+    CHECK(actual == expected);
+  }
+
+  SUBCASE("polygon") {
+    geo::simple_polygon const ring{
+        {49.0, 8.0}, {49.0, 9.0}, {50.0, 9.0}, {50.0, 8.0}};
+    auto const tiles = geo::clip_polygon_to_tiles<proj>(ring, kZ, kBuffer);
+    check_bounds(tiles);
+
+    auto const range = geo::make_tile_range(ring[0], ring[2], kZ);
+    auto n_range = 0U;
+    auto n_full = 0U;
+    for (auto const& t : range) {
+      ++n_range;
+      (void)t;
+    }
+    for (auto const& t : tiles) {
+      REQUIRE(t.parts_.size() == 1U);
+      // interior tiles: the buffered tile square
+      auto const& part = t.parts_[0];
+      auto const is_corner = [](geo::pixel_coord_t const v) {
+        return v == -kBuffer || v == proj::kTileSize + kBuffer;
+      };
+      n_full += part.size() == 4U &&
+                        std::all_of(begin(part), end(part),
+                                    [&](pixel_xy const& p) {
+                                      return is_corner(p.x_) &&
+                                             is_corner(p.y_);
+                                    })
+                    ? 1U
+                    : 0U;
+    }
+    CHECK(tiles.size() >= n_range);
+    CHECK(tiles.size() <= n_range + 2U * 20U);
+    CHECK(n_full > 0U);
+  }
+
+  SUBCASE("empty") {
+    CHECK(geo::clip_line_to_tiles<proj>({}, kZ, kBuffer).empty());
+    CHECK(geo::clip_polygon_to_tiles<proj>({{49.0, 8.0}, {50.0, 8.0}}, kZ,
+                                           kBuffer)
+              .empty());
+  }
+}
@@ -0,0 +1,199 @@
+#include "doctest/doctest.h"
+
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "geo/tile_cover.h"
+#include "geo/webmercator.h"
+
+namespace {
+
+using tile_xy = geo::merc_xy;
+
+tile_xy to_tile_xy(geo::latlng const& pos, uint32_t const z) {
+  auto const merc = geo::latlng_to_merc(pos);
+  auto const scale = static_cast<double>(1U << z) / (2 * geo::kMercOriginShift);
+  return {(merc.x_ + geo::kMercOriginShift) * scale,
+          (geo::kMercOriginShift - merc.y_) * scale};
+}
+
+// Liang-Barsky: segment a-b intersects [x, x + 1] x [y, y + 1]
+bool intersects(tile_xy const& a, tile_xy const& b, double const x,
+                double const y) {
+  auto t0 = 0.0, t1 = 1.0;
+  auto const clip = [&](double const p, double const q) {
+    if (p == 0.0) {
+      return q >= 0.0;
+    }
+    auto const r = q / p;
+    if (p < 0.0) {
+      t0 = std::max(t0, r);
+    } else {
+      t1 = std::min(t1, r);
+    }
+    return t0 <= t1;
+  };
+  auto const dx = b.x_ - a.x_;
+  auto const dy = b.y_ - a.y_;
+  return clip(-dx, a.x_ - x) && clip(dx, x + 1.0 - a.x_) &&
+         clip(-dy, a.y_ - y) && clip(dy, y + 1.0 - a.y_);
+}
+
+bool inside(std::vector<tile_xy> const& ring, double const x, double const y) {
+  auto in = false;
+  for (auto i = std::size_t{0U}, j = ring.size() - 1U; i < ring.size();
+       j = i++) {
+    if ((ring[i].y_ > y) != (ring[j].y_ > y) &&
+        x < (ring[j].x_ - ring[i].x_) * (y - ring[i].y_) /
+                    (ring[j].y_ - ring[i].y_) +
+                ring[i].x_) {
+      in = !in;
+    }
+  }
+  return in;
+}
+
+std::vector<geo::tile_id> all_tiles(uint32_t const z) {
+  std::vector<geo::tile_id> tiles;
+  for (auto const& t : geo::make_tile_range(z)) {
+    tiles.emplace_back(t);
+  }
+  std::sort(begin(tiles), end(tiles));
+  return tiles;
+}
+
+}  // namespace
+
+TEST_CASE("tile_cover line") {
+  SUBCASE("empty and single point") {
+    CHECK(geo::tile_cover_line({}, 10U).empty());
+
+    auto const darmstadt = geo::latlng{49.8728, 8.6512};
+    auto const cover = geo::tile_cover_line({darmstadt}, 14U);
+    REQUIRE(cover.size() == 1U);
+    CHECK(cover.front().as_tile() == geo::tile(8585, 5565, 14));
+  }
+
+  SUBCASE("random lines vs. brute force") {
+    constexpr auto const kZ = 6U;
+    std::mt19937 gen{0};
+    std::uniform_real_distribution<> lat_dist{-80., 80.};
+    std::uniform_real_distribution<> lng_dist{-180., 180.};
+
+    auto const tiles = all_tiles(kZ);
+    for (auto i = 0; i < 50; ++i) {
+      geo::polyline line;
+      for (auto j = 0; j < 4; ++j) {
+        line.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+      }
+
+      std::vector<geo::tile_id> expected;
+      for (auto const& t : tiles) {
+        auto const tile = t.as_tile();
+        for (auto j = 1U; j < line.size(); ++j) {
+          if (intersects(to_tile_xy(line[j - 1U], kZ), to_tile_xy(line[j], kZ),
+                         tile.x_, tile.y_)) {
+            expected.push_back(t);
+            break;
+          }
+        }
+      }
+
+      auto const cover = geo::tile_cover_line(line, kZ);
+      CHECK(cover == expected);
+      CHECK(cover.size() <
+            geo::tile_cover_box(geo::box{line}, kZ).size() + 1U);
+    }
+  }
+}
+
+TEST_CASE("tile_cover polygon") {
+  SUBCASE("random polygons vs. brute force") {
+    constexpr auto const kZ = 5U;
+    std::mt19937 gen{0};
+    std::uniform_real_distribution<> lat_dist{-80., 80.};
+    std::uniform_real_distribution<> lng_dist{-180., 180.};
+
+    auto const tiles = all_tiles(kZ);
+    for (auto i = 0; i < 50; ++i) {
+      geo::simple_polygon ring;
+      for (auto j = 0; j < 6; ++j) {
+        ring.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+      }
+
+      std::vector<tile_xy> ring_xy;
+      for (auto const& pos : ring) {
+        ring_xy.push_back(to_tile_xy(pos, kZ));
+      }
+
+      std::vector<geo::tile_id> expected;
+      for (auto const& t : tiles) {
+        auto const tile = t.as_tile();
+        auto hit = inside(ring_xy, tile.x_ + 0.5, tile.y_ + 0.5);
+        for (auto j = 0U; !hit && j < ring_xy.size(); ++j) {
+          hit = intersects(ring_xy[j], ring_xy[(j + 1U) % ring_xy.size()],
+                           tile.x_, tile.y_);
+        }
+        if (hit) {
+          expected.push_back(t);
+        }
+      }
+
+      CHECK(geo::tile_cover_polygon(ring, kZ) == expected);
+    }
+  }
+
+  SUBCASE("diagonal route vs. bounding box") {
+    geo::polyline const route{{49.8728, 8.6512}, {52.5200, 13.4050}};
+    auto const line_cover = geo::tile_cover_line(route, 14U);
+    auto const box_cover = geo::tile_cover_box(geo::box{route}, 14U);
+    CHECK(line_cover.size() < box_cover.size() / 100U);
+    CHECK(std::includes(begin(box_cover), end(box_cover), begin(line_cover),
+                        end(line_cover)));
+  }
+}
+
+TEST_CASE("tile_cover box") {
+  auto const b = geo::box{geo::latlng{49.8, 8.6}, geo::latlng{49.9, 8.7}};
+  auto const cover = geo::tile_cover_box(b, 14U);
+
+  auto const range = geo::make_tile_range(b.min_, b.max_, 14U);
+  std::vector<geo::tile_id> expected;
+  for (auto const& t : range) {
+    expected.emplace_back(t);
+  }
+  std::sort(begin(expected), end(expected));
+  CHECK(cover == expected);
+
+  CHECK(geo::tile_cover_box(geo::box{}, 3U).empty());
+  CHECK(geo::tile_cover_box(geo::box{{-90.0, -180.0}, {90.0, 180.0}}, 3U) ==
+        all_tiles(3U));
+}
+
+TEST_CASE("compact_tile_cover") {
+  auto const b = geo::box{geo::latlng{40.0, -10.0}, geo::latlng{60.0, 30.0}};
+  auto const cover = geo::tile_cover_box(b, 10U);
+  auto const compact = geo::compact_tile_cover(cover);
+  CHECK(compact.size() < cover.size() / 10U);
+
+  // same area, no overlap
+  std::vector<geo::tile_id> expanded;
+  for (auto const& t : compact) {
+    for (auto const& d : t.as_tile().range_on_z(10U)) {
+      expanded.emplace_back(d);
+    }
+  }
+  std::sort(begin(expanded), end(expanded));
+  CHECK(expanded == cover);
+
+  auto const limited = geo::compact_tile_cover(cover, 8U);
+  CHECK(std::all_of(begin(limited), end(limited),
+                    [](geo::tile_id const t) { return t.z() >= 8U; }));
+  CHECK(limited.size() > compact.size());
+
+  CHECK(geo::compact_tile_cover(all_tiles(4U)) ==
+        std::vector<geo::tile_id>{geo::tile_id{0U, 0U}});
+  CHECK(geo::compact_tile_cover({}).empty());
+}
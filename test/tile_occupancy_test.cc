@@ -0,0 +1,93 @@
+#include "doctest/doctest.h"
+
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "geo/tile_cover.h"
+#include "geo/tile_occupancy.h"
+
+TEST_CASE("tile_occupancy points") {
+  constexpr auto const kMaxZ = 12U;
+  std::mt19937 gen{0};
+  std::uniform_real_distribution<> lat_dist{49.0, 51.0};
+  std::uniform_real_distribution<> lng_dist{7.0, 10.0};
+
+  std::vector<geo::latlng> points;
+  for (auto i = 0; i < 5000; ++i) {
+    points.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+  }
+  auto const occupancy = geo::make_tile_occupancy(points, kMaxZ);
+
+  for (auto z = 0U; z <= kMaxZ; ++z) {
+    std::map<geo::tile_id, uint32_t> expected;
+    for (auto const& p : points) {
+      ++expected[geo::tile_at(p, z)];
+    }
+
+    auto const& level = occupancy.occupied(z);
+    REQUIRE(level.size() == expected.size());
+    auto it = begin(expected);
+    for (auto const& e : level) {
+      CHECK(e.tile_ == it->first);
+      CHECK(e.count_ == it->second);
+      CHECK(occupancy.count(e.tile_) == e.count_);
+      ++it;
+    }
+  }
+
+  CHECK(occupancy.count(geo::tile_id{0U, 0U}) == points.size());
+  CHECK(occupancy.count(geo::tile_id{geo::tile{0, 0, 5}}) == 0U);
+  CHECK(occupancy.count(geo::tile_id{0U, kMaxZ + 1U}) == 0U);
+}
+
+TEST_CASE("tile_occupancy lines") {
+  constexpr auto const kMaxZ = 10U;
+  std::vector<geo::polyline> const lines{
+      {{49.8728, 8.6512}, {52.5200, 13.4050}},
+      {{49.8728, 8.6512}, {48.1351, 11.5820}},
+      {{49.87, 8.65}, {49.88, 8.66}},
+      {{-33.8688, 151.2093}}};
+  auto const occupancy = geo::make_tile_occupancy(lines, kMaxZ);
+
+  // distinct features: the Darmstadt tile is touched by the first three lines
+  auto const darmstadt = geo::tile_at(geo::latlng{49.8728, 8.6512}, kMaxZ);
+  CHECK(occupancy.count(darmstadt) == 3U);
+  CHECK(occupancy.count(darmstadt.ancestor(3U)) == 3U);
+  CHECK(occupancy.count(geo::tile_id{0U, 0U}) == 4U);
+
+  for (auto z = 0U; z <= kMaxZ; ++z) {
+    std::map<geo::tile_id, std::set<std::size_t>> expected;
+    for (auto i = 0U; i < lines.size(); ++i) {
+      for (auto const& t : geo::tile_cover_line(lines[i], z)) {
+        expected[t].insert(i);
+      }
+    }
+    auto const& level = occupancy.occupied(z);
+    REQUIRE(level.size() == expected.size());
+    for (auto const& e : level) {
+      CHECK(e.count_ == expected.at(e.tile_).size());
+    }
+  }
+
+  SUBCASE("for_each_occupied") {
+    auto const root = darmstadt.ancestor(4U);
+    std::vector<geo::tile_id> visited;
+    occupancy.for_each_occupied(root, kMaxZ,
+                                [&](geo::tile_occupancy::entry const& e) {
+                                  CHECK(root.contains(e.tile_));
+                                  visited.push_back(e.tile_);
+                                });
+
+    auto expected = std::vector<geo::tile_id>{};
+    for (auto const& e : occupancy.occupied(kMaxZ)) {
+      if (root.contains(e.tile_)) {
+        expected.push_back(e.tile_);
+      }
+    }
+    CHECK(!visited.empty());
+    CHECK(visited == expected);
+    CHECK(visited.size() < (1U << (2U * (kMaxZ - 4U))) / 50U);
+  }
+}
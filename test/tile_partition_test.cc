@@ -0,0 +1,112 @@
+#include "doctest/doctest.h"
+
+#include <atomic>
+#include <vector>
+
+#include "geo/tile_partition.h"
+
+namespace {
+
+std::vector<geo::tile> list_tiles(geo::tile_partition const& p) {
+  std::vector<geo::tile> vec;
+  p.for_each([&](geo::tile const& t) { vec.push_back(t); });
+  return vec;
+}
+
+}  // namespace
+
+TEST_CASE("tile_pyramid") {
+  SUBCASE("full pyramid matches tile_iterator") {
+    auto const pyramid = geo::tile_pyramid::full(5U);
+    CHECK(pyramid.size() == 1U + 4U + 16U + 64U + 256U + 1024U);
+    CHECK(pyramid.level_size(3U) == 64U);
+    CHECK(pyramid.level_size(6U) == 0U);
+
+    std::vector<geo::tile> expected;
+    for (auto const& t : geo::make_tile_pyramid<geo::webmercator<256, 5>>()) {
+      expected.push_back(t);
+    }
+    REQUIRE(expected.size() == pyramid.size());
+
+    auto const partition = geo::tile_partition{pyramid};
+    CHECK(list_tiles(partition) == expected);
+    for (auto i = 0U; i < expected.size(); ++i) {
+      CHECK(pyramid.at(i) == expected[i]);
+      CHECK(partition[i] == expected[i]);
+    }
+  }
+
+  SUBCASE("subtree") {
+    geo::tile const t{8585, 5565, 14};
+    auto const pyramid = geo::tile_pyramid::subtree(t, 17U);
+    CHECK(pyramid.size() == 1U + 4U + 16U + 64U);
+
+    std::vector<geo::tile> expected;
+    for (auto z = 14U; z <= 17U; ++z) {
+      for (auto const& c : t.range_on_z(z)) {
+        expected.push_back(c);
+      }
+    }
+    CHECK(list_tiles(geo::tile_partition{pyramid}) == expected);
+  }
+
+  SUBCASE("deep pyramid") {
+    auto const pyramid = geo::tile_pyramid::full(29U);
+    CHECK(pyramid.size() == ((1ULL << 60U) - 1U) / 3U);
+    CHECK(pyramid.at(pyramid.size() - 1U) ==
+          geo::tile((1U << 29U) - 1U, (1U << 29U) - 1U, 29U));
+  }
+}
+
+TEST_CASE("tile_partition") {
+  auto const pyramid = geo::tile_pyramid{
+      geo::tile_iterator_bounds{2U, 4U, 5U, 6U}, 3U, 9U};
+  auto const all = geo::tile_partition{pyramid};
+  auto const expected = list_tiles(all);
+  REQUIRE(expected.size() == all.size());
+
+  SUBCASE("split") {
+    for (auto const n : {1U, 2U, 7U, 100U, 1000U}) {
+      auto const parts = all.split(n);
+      REQUIRE(parts.size() == n);
+
+      std::vector<geo::tile> joined;
+      for (auto const& p : parts) {
+        CHECK(p.size() >= all.size() / n);
+        CHECK(p.size() <= all.size() / n + 1U);
+        auto const tiles = list_tiles(p);
+        CHECK(tiles.size() == p.size());
+        if (!p.empty()) {
+          CHECK(tiles.front() == p[0U]);
+        }
+        joined.insert(end(joined), begin(tiles), end(tiles));
+      }
+      CHECK(joined == expected);
+    }
+
+    auto const nested = all.split(3U)[1U].split(4U);
+    CHECK(nested.front().from_ == all.split(3U)[1U].from_);
+    CHECK(nested.back().to_ == all.split(3U)[1U].to_);
+    CHECK(all.split(0U).empty());
+  }
+
+  SUBCASE("parallel_for_each_tile") {
+    std::vector<std::atomic_size_t> visits(expected.size());
+    geo::parallel_for_each_tile(
+        all,
+        [&](geo::tile const& t) {
+          auto const z_offset =
+              geo::tile_partition{geo::tile_pyramid{pyramid.bounds_,
+                                                    pyramid.min_z_, t.z_ - 1U}}
+                  .size();
+          auto const b = pyramid.bounds_on_z(t.z_);
+          auto const idx = z_offset + (t.y_ - b.miny_) * (b.maxx_ - b.minx_) +
+                           (t.x_ - b.minx_);
+          ++visits[idx];
+        },
+        64U);
+    for (auto i = 0U; i < visits.size(); ++i) {
+      CHECK(visits[i] == 1U);
+    }
+  }
+}
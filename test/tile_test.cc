@@ -1,7 +1,10 @@
 #include "doctest/doctest.h"
 
+#include <algorithm>
+#include <random>
 #include <vector>
 
+#include "geo/latlng.h"
 #include "geo/tile.h"
 
 std::vector<geo::tile> list_tiles(geo::tile_range const& range) {
@@ -193,3 +196,123 @@ TEST_CASE("tile_range") {
     }
   }
 }
+
+TEST_CASE("tile_id") {
+  SUBCASE("morton") {
+    CHECK(geo::morton_encode(0U, 0U) == 0U);
+    CHECK(geo::morton_encode(1U, 0U) == 1U);
+    CHECK(geo::morton_encode(0U, 1U) == 2U);
+    CHECK(geo::morton_encode(0xFFFFFFFFU, 0U) == 0x5555555555555555ULL);
+    CHECK(geo::morton_encode(0U, 0xFFFFFFFFU) == 0xAAAAAAAAAAAAAAAAULL);
+
+    std::mt19937 gen{0};
+    std::uniform_int_distribution<uint32_t> dist;
+    for (auto i = 0; i < 1000; ++i) {
+      auto const x = dist(gen);
+      auto const y = dist(gen);
+      auto const [a, b] = geo::morton_decode(geo::morton_encode(x, y));
+      CHECK(a == x);
+      CHECK(b == y);
+    }
+  }
+
+  SUBCASE("tile arithmetic") {
+    geo::tile const t{17170, 11131, 15};
+    geo::tile_id const id{t};
+    CHECK(id.z() == 15U);
+    CHECK(id.as_tile() == t);
+    CHECK(id.quad_pos() == t.quad_pos());
+    CHECK(id.parent().as_tile() == t.parent());
+    CHECK(id.parent().child(id.quad_pos()) == id);
+    CHECK(id.ancestor(15U) == id);
+    CHECK(id.ancestor(14U).as_tile() == geo::tile(8585, 5565, 14));
+    CHECK(id.ancestor(0U).as_tile() == geo::tile(0, 0, 0));
+    CHECK(geo::tile_id{0U, 0U}.contains(id));
+    CHECK(id.ancestor(3U).contains(id));
+    CHECK(!id.contains(id.parent()));
+    CHECK(!id.parent().contains(geo::tile_id{geo::tile{17172, 11131, 15}}));
+
+    for (auto const& c : list_tiles(t.direct_children())) {
+      CHECK(geo::tile_id{c}.parent() == id);
+      CHECK(id.child(c.quad_pos()).as_tile() == c);
+    }
+  }
+
+  SUBCASE("descendant range") {
+    geo::tile const t{56, 84, 7};
+    geo::tile_id const id{t};
+    auto const first = id.first_descendant(9U);
+    auto const last = id.last_descendant(9U);
+    CHECK(last.morton() - first.morton() + 1U == 16U);
+
+    auto const children = list_tiles(t.range_on_z(9U));
+    for (auto const& c : children) {
+      auto const c_id = geo::tile_id{c};
+      CHECK(!(c_id < first));
+      CHECK(!(last < c_id));
+      CHECK(id.contains(c_id));
+    }
+    CHECK(geo::tile_id{geo::tile{223, 336, 9}} < first);
+    CHECK(last < geo::tile_id{geo::tile{228, 339, 9}});
+    CHECK(id.first_descendant(7U) == id);
+    CHECK(id.last_descendant(7U) == id);
+  }
+
+  SUBCASE("order") {
+    std::vector<geo::tile_id> ids;
+    for (auto const& t : geo::make_tile_range(3U)) {
+      ids.emplace_back(t);
+    }
+    for (auto const& t : geo::make_tile_range(2U)) {
+      ids.emplace_back(t);
+    }
+    std::sort(begin(ids), end(ids));
+    for (auto i = 1U; i < ids.size(); ++i) {
+      CHECK(ids[i - 1U].z() <= ids[i].z());
+      if (ids[i - 1U].z() == ids[i].z()) {
+        CHECK(!(ids[i].parent() < ids[i - 1U].parent()));
+      }
+    }
+  }
+}
+
+TEST_CASE("tile_hash") {
+  // previous implementation: walk up the tile tree from z16
+  auto const reference_hash_32 = [](geo::latlng const& pos) {
+    uint32_t hash = 0U;
+    auto const merc = geo::latlng_to_merc(pos);
+    using proj = geo::webmercator<1>;
+    geo::tile t{static_cast<uint32_t>(proj::merc_to_pixel_x(merc.x_, 16U)),
+                static_cast<uint32_t>(proj::merc_to_pixel_y(merc.y_, 16U)),
+                16U};
+    for (auto offset = 0U; offset < 32U; offset += 2) {
+      hash = hash | t.quad_pos() << offset;
+      t = t.parent();
+    }
+    return hash;
+  };
+
+  std::mt19937 gen{0};
+  std::uniform_real_distribution<> lat_dist{-90., 90.};
+  std::uniform_real_distribution<> lng_dist{-180., 180.};
+  auto positions = std::vector<geo::latlng>{{0.0, 0.0},
+                                            {90.0, 180.0},
+                                            {-90.0, -180.0},
+                                            {49.8728, 8.6512},
+                                            {-33.8688, 151.2093}};
+  for (auto i = 0; i < 10'000; ++i) {
+    positions.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+  }
+
+  for (auto const& pos : positions) {
+    CAPTURE(pos);
+    CHECK(geo::tile_hash_32(pos) == reference_hash_32(pos));
+
+    // z32 tile: same prefix up to rounding (y) and wrap around (x = 2^16)
+    // of tile_hash_32
+    auto const [x_64, y_64] = geo::morton_decode(geo::tile_hash_64(pos));
+    auto const [x_32, y_32] = geo::morton_decode(geo::tile_hash_32(pos));
+    CHECK(((x_64 >> 16U) - x_32 + 1U) % 65536U <= 1U);
+    CHECK(((y_64 >> 16U) - y_32 + 1U) % 65536U <= 1U);
+  }
+}
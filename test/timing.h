@@ -0,0 +1,15 @@
+#pragma once
+
+#include <chrono>
+
+// Timings printed by the perf tests. Their input sizes are kept small for
+// the regular test run: increase them for perf evaluation.
+
+#define GEO_START_TIMING(_X)                         \
+  auto _X##_start = std::chrono::steady_clock::now(), \
+       _X##_stop = _X##_start
+#define GEO_STOP_TIMING(_X) _X##_stop = std::chrono::steady_clock::now()
+#define GEO_TIMING_MS(_X)                                          \
+  (std::chrono::duration_cast<std::chrono::milliseconds>(_X##_stop - \
+                                                         _X##_start) \
+       .count())
@@ -0,0 +1,178 @@
+#include "doctest/doctest.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "geo/detail/fast_math.h"
+#include "geo/fixed_latlng.h"
+#include "geo/webmercator.h"
+#include "geo/webmercator_batch.h"
+
+#include "timing.h"
+
+namespace {
+
+std::vector<geo::latlng> random_coords(std::size_t const n) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<> lat_dist{-90., 90.};
+  std::uniform_real_distribution<> lng_dist{-180., 180.};
+  std::vector<geo::latlng> coords;
+  coords.reserve(n);
+  for (auto i = 0U; i < n; ++i) {
+    coords.push_back(geo::latlng{lat_dist(gen), lng_dist(gen)});
+  }
+  return coords;
+}
+
+}  // namespace
+
+TEST_CASE("fast_math error bounds") {
+  using namespace geo::detail;
+
+  auto max_sin = 0.0, max_atan = 0.0, max_log = 0.0, max_exp = 0.0;
+  constexpr auto kSteps = 100'000;
+  for (auto i = 0; i <= kSteps; ++i) {
+    auto const f = static_cast<double>(i) / kSteps;
+
+    auto const x_sin = (2.0 * f - 1.0) * geo::kPI / 2.0;
+    max_sin = std::max(max_sin, std::abs(fast_sin(x_sin) - std::sin(x_sin)));
+
+    auto const x_atan = 2.0 * f - 1.0;
+    max_atan =
+        std::max(max_atan, std::abs(fast_atan(x_atan) - std::atan(x_atan)));
+
+    auto const x_log = std::exp(80.0 * f - 40.0);
+    max_log = std::max(max_log, std::abs(fast_log(x_log) - std::log(x_log)) /
+                                    std::max(1.0, std::abs(std::log(x_log))));
+
+    auto const x_exp = 1400.0 * f - 700.0;
+    max_exp = std::max(
+        max_exp, std::abs(fast_exp(x_exp) - std::exp(x_exp)) / std::exp(x_exp));
+  }
+
+  CHECK(max_sin < 1e-15);
+  CHECK(max_atan < 1e-15);
+  CHECK(max_log < 1e-15);
+  CHECK(max_exp < 1e-15);
+
+  CHECK(fast_log(1.0) == 0.0);
+  CHECK(fast_exp(0.0) == 1.0);
+  CHECK(fast_sin(0.0) == 0.0);
+  CHECK(fast_atan(0.0) == 0.0);
+}
+
+TEST_CASE("webmercator batch") {
+  using proj = geo::default_webmercator;
+
+  constexpr auto kSize = 100'000;
+  auto const coords = random_coords(kSize);
+
+  GEO_START_TIMING(scalar);
+  std::vector<geo::merc_xy> expected;
+  expected.reserve(kSize);
+  for (auto const& c : coords) {
+    expected.push_back(geo::latlng_to_merc(c));
+  }
+  GEO_STOP_TIMING(scalar);
+
+  GEO_START_TIMING(batch);
+  std::vector<geo::merc_xy> merc;
+  geo::latlng_to_merc(coords, merc);
+  GEO_STOP_TIMING(batch);
+
+  GEO_START_TIMING(parallel);
+  std::vector<geo::merc_xy> merc_parallel;
+  geo::latlng_to_merc(coords, merc_parallel, true);
+  GEO_STOP_TIMING(parallel);
+
+  std::cout << "latlng_to_merc scalar: " << GEO_TIMING_MS(scalar)
+            << " ms, batch: " << GEO_TIMING_MS(batch)
+            << " ms, parallel: " << GEO_TIMING_MS(parallel) << " ms\n";
+
+  SUBCASE("latlng to merc") {
+    REQUIRE(merc.size() == coords.size());
+    REQUIRE(merc_parallel.size() == coords.size());
+    for (auto i = 0U; i < coords.size(); ++i) {
+      CHECK(merc[i].x_ == expected[i].x_);
+      CHECK(std::abs(merc[i].y_ - expected[i].y_) < 1e-6);
+      CHECK(merc_parallel[i].x_ == merc[i].x_);
+      CHECK(merc_parallel[i].y_ == merc[i].y_);
+
+      // used by the batch functions in AVX2 / AVX-512 builds only
+      auto const fast = geo::fast_latlng_to_merc(coords[i]);
+      CHECK(fast.x_ == expected[i].x_);
+      CHECK(std::abs(fast.y_ - expected[i].y_) < 1e-6);
+    }
+  }
+
+  SUBCASE("merc to latlng") {
+    std::vector<geo::latlng> back;
+    geo::merc_to_latlng(merc, back, true);
+    REQUIRE(back.size() == coords.size());
+    for (auto i = 0U; i < coords.size(); ++i) {
+      auto const ref = geo::merc_to_latlng(merc[i]);
+      CHECK(std::abs(back[i].lat_ - ref.lat_) < 1e-12);
+      CHECK(std::abs(back[i].lng_ - ref.lng_) < 1e-12);
+
+      auto const fast = geo::fast_merc_to_latlng(merc[i]);
+      CHECK(std::abs(fast.lat_ - ref.lat_) < 1e-12);
+      CHECK(std::abs(fast.lng_ - ref.lng_) < 1e-12);
+
+      auto const lat = std::clamp(coords[i].lat_, -geo::kMercMaxLatitude,
+                                  geo::kMercMaxLatitude);
+      CHECK(std::abs(back[i].lat_ - lat) < 1e-9);
+      CHECK(std::abs(back[i].lng_ - coords[i].lng_) < 1e-9);
+    }
+  }
+
+  SUBCASE("pixel") {
+    for (auto const z : {0U, 10U, 20U}) {
+      std::vector<geo::pixel_xy> px;
+      geo::latlng_to_pixel<proj>(coords, z, px, true);
+      REQUIRE(px.size() == coords.size());
+
+      auto mismatch = 0U;
+      for (auto i = 0U; i < coords.size(); ++i) {
+        auto const ref = proj::merc_to_pixel(expected[i], z);
+        CHECK(px[i].x_ == ref.x_);
+        CHECK(std::abs(px[i].y_ - ref.y_) <= 1);
+        mismatch += px[i].y_ != ref.y_ ? 1U : 0U;
+      }
+      CHECK(mismatch < coords.size() / 1000U);
+
+      std::vector<geo::latlng> back;
+      geo::pixel_to_latlng<proj>(px, z, back);
+      REQUIRE(back.size() == px.size());
+      for (auto i = 0U; i < px.size(); ++i) {
+        auto const ref = geo::merc_to_latlng(proj::pixel_to_merc(px[i], z));
+        CHECK(std::abs(back[i].lat_ - ref.lat_) < 1e-12);
+        CHECK(std::abs(back[i].lng_ - ref.lng_) < 1e-12);
+      }
+    }
+  }
+
+  SUBCASE("fixed_latlng") {
+    std::vector<geo::fixed_latlng> fixed;
+    for (auto const& c : coords) {
+      fixed.push_back(geo::fixed_latlng::from_latlng(c));
+    }
+
+    std::vector<geo::merc_xy> fixed_merc;
+    geo::latlng_to_merc(fixed, fixed_merc);
+    REQUIRE(fixed_merc.size() == fixed.size());
+    for (auto i = 0U; i < fixed.size(); ++i) {
+      auto const ref = geo::latlng_to_merc(static_cast<geo::latlng>(fixed[i]));
+      CHECK(fixed_merc[i].x_ == ref.x_);
+      CHECK(std::abs(fixed_merc[i].y_ - ref.y_) < 1e-6);
+    }
+  }
+
+  SUBCASE("empty") {
+    std::vector<geo::latlng> empty;
+    std::vector<geo::merc_xy> out{geo::merc_xy{1.0, 2.0}};
+    geo::latlng_to_merc(empty, out, true);
+    CHECK(out.empty());
+  }
+}
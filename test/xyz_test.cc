@@ -1,6 +1,5 @@
 #include "doctest/doctest.h"
 
-#include <chrono>
 #include <iostream>
 #include <random>
 #include <vector>
@@ -8,13 +7,7 @@
 #include "geo/latlng.h"
 #include "geo/xyz.h"
 
-namespace sc = std::chrono;
-
-#define GEO_START_TIMING(_X) \
-  auto _X##_start = sc::steady_clock::now(), _X##_stop = _X##_start
-#define GEO_STOP_TIMING(_X) _X##_stop = sc::steady_clock::now()
-#define GEO_TIMING_MS(_X) \
-  (sc::duration_cast<sc::milliseconds>(_X##_stop - _X##_start).count())
+#include "timing.h"
 
 TEST_CASE("xyz haversine_distance") {
   constexpr auto kSize = 100;  // increase this number for perf eval